@@ -0,0 +1,156 @@
+#include <benchmark/benchmark.h>
+
+#include <sourcemeta/blaze/foundation.h>
+#include <sourcemeta/core/json.h>
+
+#include <sourcemeta/jsonbinpack/compiler.h>
+#include <sourcemeta/jsonbinpack/runtime.h>
+
+#include <cstddef> // std::byte, std::size_t
+#include <cstdint> // std::int64_t
+#include <sstream> // std::ostringstream, std::istringstream
+#include <string>  // std::string
+#include <vector>  // std::vector
+
+#include "corpus.h"
+
+// Benchmark the schema-less encoding, as the CLI does by default, so that
+// every corpus entry is supported
+static auto schema_less_encoding() -> sourcemeta::jsonbinpack::Encoding {
+  auto schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema"
+  })JSON")};
+  sourcemeta::jsonbinpack::compile(schema, sourcemeta::blaze::schema_walker,
+                                   sourcemeta::blaze::schema_resolver);
+  return sourcemeta::jsonbinpack::load(schema);
+}
+
+static auto
+encode_corpus(const std::vector<sourcemeta::core::JSON> &instances,
+              const sourcemeta::jsonbinpack::Encoding &encoding)
+    -> std::vector<std::byte> {
+  std::vector<std::byte> result;
+  sourcemeta::jsonbinpack::Encoder encoder{result};
+  for (const auto &instance : instances) {
+    encoder.write(instance, encoding);
+  }
+
+  return result;
+}
+
+static void BinPack_Encode_Stream(benchmark::State &state,
+                                  const std::string &name) {
+  const auto encoding{schema_less_encoding()};
+  const auto instances{sourcemeta::jsonschema::corpus::read_instances(name)};
+  const auto size{encode_corpus(instances, encoding).size()};
+  for (auto _ : state) {
+    std::ostringstream stream;
+    sourcemeta::jsonbinpack::Encoder encoder{stream};
+    for (const auto &instance : instances) {
+      encoder.write(instance, encoding);
+    }
+
+    benchmark::DoNotOptimize(stream);
+  }
+
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(size));
+}
+
+static void BinPack_Encode_Buffer(benchmark::State &state,
+                                  const std::string &name) {
+  const auto encoding{schema_less_encoding()};
+  const auto instances{sourcemeta::jsonschema::corpus::read_instances(name)};
+  const auto size{encode_corpus(instances, encoding).size()};
+  for (auto _ : state) {
+    auto result{encode_corpus(instances, encoding)};
+    benchmark::DoNotOptimize(result);
+  }
+
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(size));
+}
+
+static void BinPack_Decode_Stream(benchmark::State &state,
+                                  const std::string &name) {
+  const auto encoding{schema_less_encoding()};
+  const auto instances{sourcemeta::jsonschema::corpus::read_instances(name)};
+  const auto bytes{encode_corpus(instances, encoding)};
+  const std::string payload{reinterpret_cast<const char *>(bytes.data()),
+                            bytes.size()};
+  for (auto _ : state) {
+    std::istringstream stream{payload};
+    sourcemeta::jsonbinpack::Decoder decoder{stream};
+    for (std::size_t index = 0; index < instances.size(); index++) {
+      auto result{decoder.read(encoding)};
+      benchmark::DoNotOptimize(result);
+    }
+  }
+
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(payload.size()));
+}
+
+static void BinPack_Decode_Buffer(benchmark::State &state,
+                                  const std::string &name) {
+  const auto encoding{schema_less_encoding()};
+  const auto instances{sourcemeta::jsonschema::corpus::read_instances(name)};
+  const auto bytes{encode_corpus(instances, encoding)};
+  for (auto _ : state) {
+    sourcemeta::jsonbinpack::Decoder decoder{bytes};
+    for (std::size_t index = 0; index < instances.size(); index++) {
+      auto result{decoder.read(encoding)};
+      benchmark::DoNotOptimize(result);
+    }
+  }
+
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(bytes.size()));
+}
+
+// Turn the decoded documents into prettified JSON text, as the CLI does
+static void BinPack_Decode_Prettify(benchmark::State &state,
+                                    const std::string &name) {
+  const auto encoding{schema_less_encoding()};
+  const auto instances{sourcemeta::jsonschema::corpus::read_instances(name)};
+  const auto bytes{encode_corpus(instances, encoding)};
+  for (auto _ : state) {
+    sourcemeta::jsonbinpack::Decoder decoder{bytes};
+    std::ostringstream stream;
+    for (std::size_t index = 0; index < instances.size(); index++) {
+      sourcemeta::core::prettify(decoder.read(encoding), stream);
+    }
+
+    benchmark::DoNotOptimize(stream);
+  }
+
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(bytes.size()));
+}
+
+static void BinPack_Decode_Writer(benchmark::State &state,
+                                  const std::string &name) {
+  const auto encoding{schema_less_encoding()};
+  const auto instances{sourcemeta::jsonschema::corpus::read_instances(name)};
+  const auto bytes{encode_corpus(instances, encoding)};
+  for (auto _ : state) {
+    sourcemeta::jsonbinpack::Decoder decoder{bytes};
+    std::ostringstream stream;
+    for (std::size_t index = 0; index < instances.size(); index++) {
+      sourcemeta::jsonbinpack::DecoderWriter writer{stream, true};
+      decoder.read(encoding, writer);
+    }
+
+    benchmark::DoNotOptimize(stream);
+  }
+
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(bytes.size()));
+}
+
+JSONSCHEMA_BENCHMARK_CORPUS(BinPack_Encode_Stream);
+JSONSCHEMA_BENCHMARK_CORPUS(BinPack_Encode_Buffer);
+JSONSCHEMA_BENCHMARK_CORPUS(BinPack_Decode_Stream);
+JSONSCHEMA_BENCHMARK_CORPUS(BinPack_Decode_Buffer);
+JSONSCHEMA_BENCHMARK_CORPUS(BinPack_Decode_Prettify);
+JSONSCHEMA_BENCHMARK_CORPUS(BinPack_Decode_Writer);
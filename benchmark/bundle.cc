@@ -0,0 +1,21 @@
+#include <benchmark/benchmark.h>
+
+#include <sourcemeta/blaze/bundle.h>
+#include <sourcemeta/blaze/foundation.h>
+
+#include <string> // std::string
+
+#include "corpus.h"
+
+static void Bundle(benchmark::State &state, const std::string &name) {
+  const auto schema{sourcemeta::jsonschema::corpus::read_schema(name)};
+  for (auto _ : state) {
+    auto result{sourcemeta::blaze::bundle(
+        schema, sourcemeta::blaze::schema_walker,
+        sourcemeta::blaze::schema_resolver,
+        sourcemeta::blaze::BundleMode::References)};
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+JSONSCHEMA_BENCHMARK_CORPUS(Bundle);
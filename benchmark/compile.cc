@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+
+#include <sourcemeta/blaze/bundle.h>
+#include <sourcemeta/blaze/compiler.h>
+#include <sourcemeta/blaze/foundation.h>
+#include <sourcemeta/blaze/frame.h>
+
+#include <string> // std::string
+
+#include "corpus.h"
+
+static auto compile_corpus(benchmark::State &state, const std::string &name,
+                           const sourcemeta::blaze::Mode mode) -> void {
+  const auto bundled{sourcemeta::blaze::bundle(
+      sourcemeta::jsonschema::corpus::read_schema(name),
+      sourcemeta::blaze::schema_walker, sourcemeta::blaze::schema_resolver,
+      sourcemeta::blaze::BundleMode::References)};
+  sourcemeta::blaze::SchemaFrame frame{
+      sourcemeta::blaze::SchemaFrame::Mode::References};
+  frame.analyse(bundled, sourcemeta::blaze::schema_walker,
+                sourcemeta::blaze::schema_resolver);
+  for (auto _ : state) {
+    auto result{sourcemeta::blaze::compile(
+        bundled, sourcemeta::blaze::schema_walker,
+        sourcemeta::blaze::schema_resolver,
+        sourcemeta::blaze::default_schema_compiler, frame, frame.root(),
+        mode)};
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+static void Compile_Fast(benchmark::State &state, const std::string &name) {
+  compile_corpus(state, name, sourcemeta::blaze::Mode::FastValidation);
+}
+
+static void Compile_Exhaustive(benchmark::State &state,
+                               const std::string &name) {
+  compile_corpus(state, name, sourcemeta::blaze::Mode::Exhaustive);
+}
+
+JSONSCHEMA_BENCHMARK_CORPUS(Compile_Fast);
+JSONSCHEMA_BENCHMARK_CORPUS(Compile_Exhaustive);
@@ -0,0 +1,98 @@
+#ifndef SOURCEMETA_JSONSCHEMA_BENCHMARK_CORPUS_H_
+#define SOURCEMETA_JSONSCHEMA_BENCHMARK_CORPUS_H_
+
+#include <sourcemeta/core/io.h>
+#include <sourcemeta/core/json.h>
+#include <sourcemeta/core/jsonl.h>
+
+#include <filesystem>  // std::filesystem::path, std::filesystem::exists
+#include <fstream>     // std::ifstream
+#include <string>      // std::string
+#include <string_view> // std::string_view
+#include <vector>      // std::vector
+
+namespace sourcemeta::jsonschema::corpus {
+
+// Entries with this prefix denote the official metaschemas, which are
+// benchmarked straight from the vendored copies so that dependency upgrades
+// are reflected without touching the corpus
+constexpr std::string_view METASCHEMA_PREFIX{"metaschema-"};
+
+inline auto schema_path(const std::string &name) -> std::filesystem::path {
+  if (name.starts_with(METASCHEMA_PREFIX)) {
+    return std::filesystem::path{METASCHEMAS_DIRECTORY} /
+           ("jsonschema-" + name.substr(METASCHEMA_PREFIX.size())) /
+           "schema.json";
+  }
+
+  return std::filesystem::path{CURRENT_DIRECTORY} / "corpus" / name /
+         "schema.json";
+}
+
+inline auto read_schema(const std::string &name) -> sourcemeta::core::JSON {
+  return sourcemeta::core::read_json(schema_path(name));
+}
+
+// Every corpus entry comes with either a single `instance.json` document or
+// an `instances.jsonl` dataset. Metaschemas are evaluated against themselves
+inline auto read_instances(const std::string &name)
+    -> std::vector<sourcemeta::core::JSON> {
+  std::vector<sourcemeta::core::JSON> result;
+  if (name.starts_with(METASCHEMA_PREFIX)) {
+    result.push_back(read_schema(name));
+    return result;
+  }
+
+  const auto directory{std::filesystem::path{CURRENT_DIRECTORY} / "corpus" /
+                       name};
+  if (std::filesystem::exists(directory / "instance.json")) {
+    result.push_back(sourcemeta::core::read_json(directory / "instance.json"));
+    return result;
+  }
+
+  std::ifstream stream{directory / "instances.jsonl"};
+  stream.exceptions(std::ifstream::badbit);
+  for (const auto &document : sourcemeta::core::JSONL{stream}) {
+    result.push_back(document);
+  }
+
+  return result;
+}
+
+// The raw bytes of the instances of a corpus entry, for parsing benchmarks
+inline auto read_instances_text(const std::string &name) -> std::string {
+  if (name.starts_with(METASCHEMA_PREFIX)) {
+    return sourcemeta::core::read_file_to_string(schema_path(name));
+  }
+
+  const auto directory{std::filesystem::path{CURRENT_DIRECTORY} / "corpus" /
+                       name};
+  if (std::filesystem::exists(directory / "instance.json")) {
+    return sourcemeta::core::read_file_to_string(directory / "instance.json");
+  }
+
+  return sourcemeta::core::read_file_to_string(directory / "instances.jsonl");
+}
+
+} // namespace sourcemeta::jsonschema::corpus
+
+// Register a benchmark function against every entry of the corpus
+#define JSONSCHEMA_BENCHMARK_CORPUS(function)                                  \
+  BENCHMARK_CAPTURE(function, metaschema_draft4,                               \
+                    std::string{"metaschema-draft4"});                         \
+  BENCHMARK_CAPTURE(function, metaschema_draft6,                               \
+                    std::string{"metaschema-draft6"});                         \
+  BENCHMARK_CAPTURE(function, metaschema_draft7,                               \
+                    std::string{"metaschema-draft7"});                         \
+  BENCHMARK_CAPTURE(function, metaschema_2019_09,                              \
+                    std::string{"metaschema-2019-09"});                        \
+  BENCHMARK_CAPTURE(function, metaschema_2020_12,                              \
+                    std::string{"metaschema-2020-12"});                        \
+  BENCHMARK_CAPTURE(function, openapi, std::string{"openapi"});                \
+  BENCHMARK_CAPTURE(function, geojson, std::string{"geojson"});                \
+  BENCHMARK_CAPTURE(function, deep, std::string{"deep"});                      \
+  BENCHMARK_CAPTURE(function, wide, std::string{"wide"});                      \
+  BENCHMARK_CAPTURE(function, recursive, std::string{"recursive"});           \
+  BENCHMARK_CAPTURE(function, expression, std::string{"expression"})
+
+#endif
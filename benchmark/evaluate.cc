@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+
+#include <sourcemeta/blaze/compiler.h>
+#include <sourcemeta/blaze/evaluator.h>
+#include <sourcemeta/blaze/foundation.h>
+
+#include <cstdint> // std::int64_t
+#include <string>  // std::string
+
+#include "corpus.h"
+
+static auto evaluate_corpus(benchmark::State &state, const std::string &name,
+                            const sourcemeta::blaze::Mode mode,
+                            const bool memoize) -> void {
+  const auto schema_template{sourcemeta::blaze::compile(
+      sourcemeta::jsonschema::corpus::read_schema(name),
+      sourcemeta::blaze::schema_walker, sourcemeta::blaze::schema_resolver,
+      sourcemeta::blaze::default_schema_compiler, mode)};
+  const auto instances{sourcemeta::jsonschema::corpus::read_instances(name)};
+  sourcemeta::blaze::Evaluator evaluator;
+  evaluator.memoize(memoize);
+
+  for (const auto &instance : instances) {
+    if (!evaluator.validate(schema_template, instance)) {
+      state.SkipWithError("The corpus instances are expected to be valid");
+      return;
+    }
+  }
+
+  for (auto _ : state) {
+    for (const auto &instance : instances) {
+      auto result{evaluator.validate(schema_template, instance)};
+      benchmark::DoNotOptimize(result);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(instances.size()));
+}
+
+static void Evaluate_Fast(benchmark::State &state, const std::string &name) {
+  evaluate_corpus(state, name, sourcemeta::blaze::Mode::FastValidation, false);
+}
+
+static void Evaluate_Fast_Memoize(benchmark::State &state,
+                                  const std::string &name) {
+  evaluate_corpus(state, name, sourcemeta::blaze::Mode::FastValidation, true);
+}
+
+static void Evaluate_Exhaustive(benchmark::State &state,
+                                const std::string &name) {
+  evaluate_corpus(state, name, sourcemeta::blaze::Mode::Exhaustive, false);
+}
+
+JSONSCHEMA_BENCHMARK_CORPUS(Evaluate_Fast);
+JSONSCHEMA_BENCHMARK_CORPUS(Evaluate_Fast_Memoize);
+JSONSCHEMA_BENCHMARK_CORPUS(Evaluate_Exhaustive);
@@ -0,0 +1,25 @@
+#include <benchmark/benchmark.h>
+
+#include <sourcemeta/blaze/bundle.h>
+#include <sourcemeta/blaze/foundation.h>
+#include <sourcemeta/blaze/frame.h>
+
+#include <string> // std::string
+
+#include "corpus.h"
+
+static void Frame(benchmark::State &state, const std::string &name) {
+  const auto bundled{sourcemeta::blaze::bundle(
+      sourcemeta::jsonschema::corpus::read_schema(name),
+      sourcemeta::blaze::schema_walker, sourcemeta::blaze::schema_resolver,
+      sourcemeta::blaze::BundleMode::References)};
+  for (auto _ : state) {
+    sourcemeta::blaze::SchemaFrame frame{
+        sourcemeta::blaze::SchemaFrame::Mode::References};
+    frame.analyse(bundled, sourcemeta::blaze::schema_walker,
+                  sourcemeta::blaze::schema_resolver);
+    benchmark::DoNotOptimize(frame);
+  }
+}
+
+JSONSCHEMA_BENCHMARK_CORPUS(Frame);
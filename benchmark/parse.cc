@@ -0,0 +1,40 @@
+#include <benchmark/benchmark.h>
+
+#include <sourcemeta/core/json.h>
+#include <sourcemeta/core/jsonl.h>
+
+#include <cstdint> // std::int64_t
+#include <sstream> // std::istringstream
+#include <string>  // std::string
+
+#include "corpus.h"
+
+static void Parse_Schema(benchmark::State &state, const std::string &name) {
+  const auto text{sourcemeta::core::read_file_to_string(
+      sourcemeta::jsonschema::corpus::schema_path(name))};
+  for (auto _ : state) {
+    auto result{sourcemeta::core::parse_json(text)};
+    benchmark::DoNotOptimize(result);
+  }
+
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(text.size()));
+}
+
+static void Parse_Instances(benchmark::State &state, const std::string &name) {
+  const auto text{sourcemeta::jsonschema::corpus::read_instances_text(name)};
+  for (auto _ : state) {
+    // Parsing a single document as JSONL is equivalent to parsing it as JSON
+    std::istringstream stream{text};
+    for (const auto &document : sourcemeta::core::JSONL{stream}) {
+      const auto *pointer{&document};
+      benchmark::DoNotOptimize(pointer);
+    }
+  }
+
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(text.size()));
+}
+
+JSONSCHEMA_BENCHMARK_CORPUS(Parse_Schema);
+JSONSCHEMA_BENCHMARK_CORPUS(Parse_Instances);
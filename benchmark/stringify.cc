@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+
+#include <sourcemeta/core/json.h>
+
+#include <cstdint> // std::int64_t
+#include <sstream> // std::ostringstream
+#include <string>  // std::string
+#include <vector>  // std::vector
+
+#include "corpus.h"
+
+static auto stringify_all(const std::vector<sourcemeta::core::JSON> &documents,
+                          const bool pretty) -> std::string {
+  std::ostringstream stream;
+  for (const auto &document : documents) {
+    if (pretty) {
+      sourcemeta::core::prettify(document, stream);
+    } else {
+      sourcemeta::core::stringify(document, stream);
+    }
+
+    stream << '\n';
+  }
+
+  return stream.str();
+}
+
+// Serialise through a string stream, like the commands do when printing
+// results, so that these also account for the cost of going through the
+// stream interface
+static auto
+serialise_corpus(benchmark::State &state,
+                 const std::vector<sourcemeta::core::JSON> &documents,
+                 const bool pretty) -> void {
+  const auto size{stringify_all(documents, pretty).size()};
+  for (auto _ : state) {
+    auto result{stringify_all(documents, pretty)};
+    benchmark::DoNotOptimize(result);
+  }
+
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(size));
+}
+
+static void Stringify_Schema(benchmark::State &state, const std::string &name) {
+  serialise_corpus(state, {sourcemeta::jsonschema::corpus::read_schema(name)},
+                   false);
+}
+
+static void Stringify_Instances(benchmark::State &state,
+                                const std::string &name) {
+  serialise_corpus(state, sourcemeta::jsonschema::corpus::read_instances(name),
+                   false);
+}
+
+static void Prettify_Schema(benchmark::State &state, const std::string &name) {
+  serialise_corpus(state, {sourcemeta::jsonschema::corpus::read_schema(name)},
+                   true);
+}
+
+static void Prettify_Instances(benchmark::State &state,
+                               const std::string &name) {
+  serialise_corpus(state, sourcemeta::jsonschema::corpus::read_instances(name),
+                   true);
+}
+
+JSONSCHEMA_BENCHMARK_CORPUS(Stringify_Schema);
+JSONSCHEMA_BENCHMARK_CORPUS(Stringify_Instances);
+JSONSCHEMA_BENCHMARK_CORPUS(Prettify_Schema);
+JSONSCHEMA_BENCHMARK_CORPUS(Prettify_Instances);
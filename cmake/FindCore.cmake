@@ -1,6 +1,6 @@
 if(NOT Core_FOUND)
   set(SOURCEMETA_CORE_INSTALL OFF CACHE BOOL "disable installation")
-  set(SOURCEMETA_CORE_CONTRIB_GOOGLEBENCHMARK OFF CACHE BOOL "GoogleBenchmark")
+  set(SOURCEMETA_CORE_CONTRIB_GOOGLEBENCHMARK ${JSONSCHEMA_BENCHMARK} CACHE BOOL "GoogleBenchmark")
   set(SOURCEMETA_CORE_EXTENSION_BUILD OFF CACHE BOOL "Build")
   set(SOURCEMETA_CORE_LANG_TEST ON CACHE BOOL "Test")
   set(SOURCEMETA_CORE_LANG_STACKTRACE ON CACHE BOOL "Stacktrace")
@@ -11,9 +11,9 @@ _jsonschema() {
     previous=""
   fi
 
-  commands="validate metaschema compile test fmt lint bundle inspect encode decode codegen install upgrade rdf version help"
+  commands="validate metaschema compile test fmt lint bundle inspect encode decode codegen install upgrade rdf openapi version help"
 
-  global_options="--verbose -v --resolve -r --default-dialect -d --json -j --http -h --debug -g --header -H"
+  global_options="--verbose -v --resolve -r --default-dialect -d --json -j --http -h --debug -g --header -H --timings -T --timings-trace"
 
   if [ "${COMP_CWORD}" -eq 1 ]
   then
@@ -44,11 +44,15 @@ _jsonschema() {
     --header|-H)
       return 0
       ;;
+    --timings-trace|--cache)
+      COMPREPLY=( $(compgen -f -- "${current}") )
+      return 0
+      ;;
     --indentation)
       COMPREPLY=( $(compgen -W "2 4 8" -- "${current}") )
       return 0
       ;;
-    --jobs|-J)
+    --jobs|-J|--shard)
       return 0
       ;;
     -n)
@@ -58,7 +62,7 @@ _jsonschema() {
       fi
       return 0
       ;;
-    --loop|-l)
+    --loop|-l|--warmup)
       return 0
       ;;
     --exclude|-x|--only|-o)
@@ -77,8 +81,14 @@ _jsonschema() {
       then
         COMPREPLY=( $(compgen -f -X '!*.json' -X '!*.yaml' -X '!*.yml' -- "${current}") )
         return 0
+      elif [ "${command}" = "decode" ]
+      then
+        return 0
       fi
       ;;
+    --from|-f|--count)
+      return 0
+      ;;
     --target)
       COMPREPLY=( $(compgen -W "typescript" -- "${current}") )
       return 0
@@ -103,7 +113,7 @@ _jsonschema() {
 
   case "${command}" in
     validate)
-      local options="--benchmark -b --loop -l --extension -e --ignore -i --trace -t --fast -f --template -m"
+      local options="--benchmark -b --loop -l --warmup -w --counters -u --extension -e --ignore -i --trace -t --fast -f --template -m --watch -W --shard --ndjson"
       if [[ ${current} == -* ]]
       then
         COMPREPLY=( $(compgen -W "${options} ${global_options}" -- "${current}") )
@@ -112,7 +122,7 @@ _jsonschema() {
       fi
       ;;
     metaschema)
-      local options="--extension -e --ignore -i --trace -t"
+      local options="--extension -e --ignore -i --trace -t --cache --shard"
       if [[ ${current} == -* ]]
       then
         COMPREPLY=( $(compgen -W "${options} ${global_options}" -- "${current}") )
@@ -130,7 +140,7 @@ _jsonschema() {
       fi
       ;;
     test)
-      local options="--extension -e --ignore -i --jobs -J"
+      local options="--extension -e --ignore -i --jobs -J --watch -W --shard"
       if [[ ${current} == -* ]]
       then
         COMPREPLY=( $(compgen -W "${options} ${global_options}" -- "${current}") )
@@ -139,7 +149,7 @@ _jsonschema() {
       fi
       ;;
     fmt)
-      local options="--check -c --extension -e --ignore -i --keep-ordering -k --indentation -n"
+      local options="--check -c --extension -e --ignore -i --keep-ordering -k --indentation -n --cache --shard"
       if [[ ${current} == -* ]]
       then
         COMPREPLY=( $(compgen -W "${options} ${global_options}" -- "${current}") )
@@ -148,7 +158,7 @@ _jsonschema() {
       fi
       ;;
     lint)
-      local options="--fix -f --extension -e --ignore -i --exclude -x --only -o --list -l --indentation -n --rule -a --top-level-rule -t"
+      local options="--fix -f --extension -e --ignore -i --exclude -x --only -o --list -l --indentation -n --rule -a --top-level-rule -t --cache --watch -W --shard"
       if [[ ${current} == -* ]]
       then
         COMPREPLY=( $(compgen -W "${options} ${global_options}" -- "${current}") )
@@ -174,17 +184,19 @@ _jsonschema() {
       fi
       ;;
     encode)
+      local options="--schema -s --jobs -J"
       if [[ ${current} == -* ]]
       then
-        COMPREPLY=( $(compgen -W "${global_options}" -- "${current}") )
+        COMPREPLY=( $(compgen -W "${options} ${global_options}" -- "${current}") )
       else
         COMPREPLY=( $(compgen -f -X '!*.json' -X '!*.jsonl' -- "${current}") )
       fi
       ;;
     decode)
+      local options="--schema -s --jobs -J --from -f --count -c"
       if [[ ${current} == -* ]]
       then
-        COMPREPLY=( $(compgen -W "${global_options}" -- "${current}") )
+        COMPREPLY=( $(compgen -W "${options} ${global_options}" -- "${current}") )
       else
         COMPREPLY=( $(compgen -f -X '!*.binpack' -- "${current}") )
       fi
@@ -225,6 +237,15 @@ _jsonschema() {
         COMPREPLY=( $(compgen -f -X '!*.json' -X '!*.yaml' -X '!*.yml' -- "${current}") )
       fi
       ;;
+    openapi)
+      local options="--fast -f --format-assertion -F --jobs -J"
+      if [[ ${current} == -* ]]
+      then
+        COMPREPLY=( $(compgen -W "${options} ${global_options}" -- "${current}") )
+      else
+        COMPREPLY=( $(compgen -f -X '!*.json' -X '!*.yaml' -X '!*.yml' -X '!*.jsonl' -X '!*.gz' -- "${current}") )
+      fi
+      ;;
     version|help)
       COMPREPLY=()
       ;;
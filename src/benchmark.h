@@ -0,0 +1,378 @@
+#ifndef SOURCEMETA_JSONSCHEMA_CLI_BENCHMARK_H_
+#define SOURCEMETA_JSONSCHEMA_CLI_BENCHMARK_H_
+
+#include <sourcemeta/blaze/evaluator.h>
+#include <sourcemeta/core/json.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h> // perf_event_attr, PERF_*
+#include <sys/ioctl.h>        // ioctl
+#include <sys/syscall.h>      // SYS_perf_event_open
+#include <unistd.h>           // syscall, close, read
+#endif
+
+#include <algorithm>   // std::sort, std::min, std::max
+#include <array>       // std::array
+#include <chrono>      // std::chrono
+#include <cmath>       // std::sqrt, std::ceil, std::llround
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint64_t, std::int64_t
+#include <optional>    // std::optional
+#include <ostream>     // std::ostream
+#include <string>      // std::string
+#include <string_view> // std::string_view
+#include <utility>     // std::move
+#include <vector>      // std::vector
+
+#include "logger.h"
+
+namespace sourcemeta::jsonschema {
+
+struct BenchmarkCounter {
+  std::string_view name;
+  // Average over the measured iterations
+  double value;
+};
+
+// Read hardware performance counters around a block of code. Counting is
+// best-effort: if the kernel does not allow it (i.e. restrictive
+// `perf_event_paranoid` settings, containers, or non-Linux systems), the
+// counters are reported as unavailable and benchmarking carries on without
+// them
+class HardwareCounters {
+public:
+  HardwareCounters() {
+#if defined(__linux__)
+    for (auto &event : this->events_) {
+      perf_event_attr attributes{};
+      attributes.size = sizeof(perf_event_attr);
+      attributes.type = PERF_TYPE_HARDWARE;
+      attributes.config = event.config;
+      attributes.disabled = this->leader_ == -1 ? 1 : 0;
+      attributes.exclude_kernel = 1;
+      attributes.exclude_hv = 1;
+      attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+      const auto descriptor{static_cast<int>(
+          syscall(SYS_perf_event_open, &attributes, 0, -1, this->leader_, 0))};
+      if (descriptor == -1) {
+        // Without the group leader there is nothing to measure
+        if (this->leader_ == -1) {
+          return;
+        }
+
+        continue;
+      }
+
+      if (ioctl(descriptor, PERF_EVENT_IOC_ID, &event.id) == -1) {
+        close(descriptor);
+        continue;
+      }
+
+      event.descriptor = descriptor;
+      if (this->leader_ == -1) {
+        this->leader_ = descriptor;
+      }
+    }
+#endif
+  }
+
+  ~HardwareCounters() {
+#if defined(__linux__)
+    for (const auto &event : this->events_) {
+      if (event.descriptor != -1) {
+        close(event.descriptor);
+      }
+    }
+#endif
+  }
+
+  HardwareCounters(const HardwareCounters &) = delete;
+  auto operator=(const HardwareCounters &) -> HardwareCounters & = delete;
+  HardwareCounters(HardwareCounters &&) = delete;
+  auto operator=(HardwareCounters &&) -> HardwareCounters & = delete;
+
+  [[nodiscard]] auto available() const noexcept -> bool {
+    return this->leader_ != -1;
+  }
+
+  auto start() -> void {
+#if defined(__linux__)
+    if (this->available()) {
+      ioctl(this->leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(this->leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  auto stop(const std::uint64_t iterations) -> std::vector<BenchmarkCounter> {
+    std::vector<BenchmarkCounter> result;
+#if defined(__linux__)
+    if (!this->available()) {
+      return result;
+    }
+
+    ioctl(this->leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // See the `PERF_FORMAT_GROUP` layout in perf_event_open(2)
+    std::array<std::uint64_t, 1 + EVENT_COUNT * 2> buffer{};
+    if (read(this->leader_, buffer.data(), sizeof(buffer)) <= 0) {
+      return result;
+    }
+
+    const auto divisor{
+        static_cast<double>(std::max(iterations, std::uint64_t{1}))};
+    for (std::uint64_t index = 0; index < buffer[0]; index++) {
+      const auto value{buffer[1 + index * 2]};
+      const auto identifier{buffer[2 + index * 2]};
+      for (const auto &event : this->events_) {
+        if (event.descriptor != -1 && event.id == identifier) {
+          result.push_back(
+              {.name = event.name,
+               .value = static_cast<double>(value) / divisor});
+          break;
+        }
+      }
+    }
+#else
+    static_cast<void>(iterations);
+#endif
+
+    return result;
+  }
+
+private:
+  int leader_{-1};
+#if defined(__linux__)
+  struct Event {
+    std::string_view name;
+    std::uint64_t config;
+    int descriptor{-1};
+    std::uint64_t id{0};
+  };
+
+  static constexpr std::size_t EVENT_COUNT{4};
+  // The first event acts as the group leader
+  std::array<Event, EVENT_COUNT> events_{
+      {{.name = "cycles", .config = PERF_COUNT_HW_CPU_CYCLES},
+       {.name = "instructions", .config = PERF_COUNT_HW_INSTRUCTIONS},
+       {.name = "branchMisses", .config = PERF_COUNT_HW_BRANCH_MISSES},
+       {.name = "cacheMisses", .config = PERF_COUNT_HW_CACHE_MISSES}}};
+#endif
+};
+
+struct BenchmarkResult {
+  std::string path;
+  std::optional<std::size_t> index;
+  bool valid;
+  std::uint64_t iterations;
+  std::uint64_t warmup;
+  // All durations are in microseconds
+  double mean;
+  double stddev;
+  double min;
+  double median;
+  double p99;
+  double max;
+  std::vector<BenchmarkCounter> counters;
+};
+
+inline auto run_benchmark(sourcemeta::blaze::Evaluator &evaluator,
+                          const sourcemeta::blaze::Template &schema_template,
+                          const sourcemeta::core::JSON &instance,
+                          std::string path, std::optional<std::size_t> index,
+                          const std::uint64_t iterations,
+                          const std::uint64_t warmup,
+                          HardwareCounters *counters) -> BenchmarkResult {
+  bool valid{true};
+
+  // Let caches, branch predictors and lazy allocations settle before
+  // measuring anything
+  for (auto remaining = warmup; remaining; remaining--) {
+    valid = evaluator.validate(schema_template, instance);
+  }
+
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  if (counters) {
+    counters->start();
+  }
+
+  for (auto remaining = iterations; remaining; remaining--) {
+    const auto start{std::chrono::steady_clock::now()};
+    valid = evaluator.validate(schema_template, instance);
+    const auto end{std::chrono::steady_clock::now()};
+    samples.push_back(
+        std::chrono::duration<double, std::micro>(end - start).count());
+  }
+
+  BenchmarkResult result{.path = std::move(path),
+                         .index = index,
+                         .valid = valid,
+                         .iterations = iterations,
+                         .warmup = warmup,
+                         .mean = 0.0,
+                         .stddev = 0.0,
+                         .min = 0.0,
+                         .median = 0.0,
+                         .p99 = 0.0,
+                         .max = 0.0,
+                         .counters = {}};
+  if (counters) {
+    result.counters = counters->stop(iterations);
+  }
+
+  if (samples.empty()) {
+    return result;
+  }
+
+  double sum{0.0};
+  for (const auto sample : samples) {
+    sum += sample;
+  }
+
+  const auto count{static_cast<double>(samples.size())};
+  result.mean = sum / count;
+  if (samples.size() > 1) {
+    double squares{0.0};
+    for (const auto sample : samples) {
+      squares += (sample - result.mean) * (sample - result.mean);
+    }
+
+    result.stddev = std::sqrt(squares / count);
+  }
+
+  // Nearest-rank percentiles
+  std::sort(samples.begin(), samples.end());
+  const auto percentile{[&samples, count](const double rank) {
+    const auto position{static_cast<std::size_t>(std::ceil(rank * count))};
+    return samples[std::min(std::max(position, std::size_t{1}),
+                            samples.size()) -
+                   1];
+  }};
+
+  result.min = samples.front();
+  result.median = percentile(0.5);
+  result.p99 = percentile(0.99);
+  result.max = samples.back();
+  return result;
+}
+
+inline auto print(const BenchmarkResult &result, std::ostream &stream)
+    -> void {
+  stream << result.path;
+  if (result.index.has_value()) {
+    stream << "[" << result.index.value() << "]";
+  }
+
+  const StreamFormatScope format{stream};
+  stream << std::fixed;
+  stream.precision(3);
+  stream << ": " << (result.valid ? "PASS" : "FAIL") << " " << result.mean
+         << " +- " << result.stddev << " us (min " << result.min << ", median "
+         << result.median << ", p99 " << result.p99 << ", max " << result.max
+         << ")";
+
+  if (!result.counters.empty()) {
+    stream << " [";
+    bool first{true};
+    for (const auto &counter : result.counters) {
+      if (!first) {
+        stream << ", ";
+      }
+
+      first = false;
+      stream << counter.name << " " << std::llround(counter.value);
+    }
+
+    stream << "]";
+  }
+
+  stream << "\n";
+}
+
+// The total time it would take to evaluate every instance once
+inline auto benchmark_total(const std::vector<BenchmarkResult> &results)
+    -> double {
+  double total{0.0};
+  for (const auto &result : results) {
+    total += result.mean;
+  }
+
+  return total;
+}
+
+inline auto benchmark_throughput(const std::vector<BenchmarkResult> &results)
+    -> double {
+  const auto total{benchmark_total(results)};
+  return total > 0.0 ? static_cast<double>(results.size()) * 1000000.0 / total
+                     : 0.0;
+}
+
+inline auto print_summary(const std::vector<BenchmarkResult> &results,
+                          std::ostream &stream) -> void {
+  const StreamFormatScope format{stream};
+  stream << std::fixed;
+  stream.precision(3);
+  stream << "throughput: " << results.size() << " instances in "
+         << benchmark_total(results) << " us ("
+         << benchmark_throughput(results) << " instances/s)\n";
+}
+
+inline auto to_json(const std::vector<BenchmarkResult> &results)
+    -> sourcemeta::core::JSON {
+  auto entries{sourcemeta::core::JSON::make_array()};
+  std::size_t valid{0};
+  for (const auto &result : results) {
+    auto entry{sourcemeta::core::JSON::make_object()};
+    entry.assign("path", sourcemeta::core::JSON{result.path});
+    if (result.index.has_value()) {
+      entry.assign("index", sourcemeta::core::JSON{result.index.value()});
+    }
+
+    entry.assign("valid", sourcemeta::core::JSON{result.valid});
+    entry.assign("iterations",
+                 sourcemeta::core::JSON{
+                     static_cast<std::size_t>(result.iterations)});
+    entry.assign("warmup", sourcemeta::core::JSON{
+                               static_cast<std::size_t>(result.warmup)});
+    entry.assign("mean", sourcemeta::core::JSON{result.mean});
+    entry.assign("stddev", sourcemeta::core::JSON{result.stddev});
+    entry.assign("min", sourcemeta::core::JSON{result.min});
+    entry.assign("median", sourcemeta::core::JSON{result.median});
+    entry.assign("p99", sourcemeta::core::JSON{result.p99});
+    entry.assign("max", sourcemeta::core::JSON{result.max});
+    if (!result.counters.empty()) {
+      auto counters{sourcemeta::core::JSON::make_object()};
+      for (const auto &counter : result.counters) {
+        counters.assign(std::string{counter.name},
+                        sourcemeta::core::JSON{counter.value});
+      }
+
+      entry.assign("counters", std::move(counters));
+    }
+
+    if (result.valid) {
+      valid += 1;
+    }
+
+    entries.push_back(std::move(entry));
+  }
+
+  auto summary{sourcemeta::core::JSON::make_object()};
+  summary.assign("instances", sourcemeta::core::JSON{results.size()});
+  summary.assign("valid", sourcemeta::core::JSON{valid});
+  summary.assign("invalid", sourcemeta::core::JSON{results.size() - valid});
+  summary.assign("total", sourcemeta::core::JSON{benchmark_total(results)});
+  summary.assign("throughput",
+                 sourcemeta::core::JSON{benchmark_throughput(results)});
+
+  auto report{sourcemeta::core::JSON::make_object()};
+  report.assign("unit", sourcemeta::core::JSON{"us"});
+  report.assign("results", std::move(entries));
+  report.assign("summary", std::move(summary));
+  return report;
+}
+
+} // namespace sourcemeta::jsonschema
+
+#endif
@@ -0,0 +1,401 @@
+#ifndef SOURCEMETA_JSONSCHEMA_CLI_BINPACK_H_
+#define SOURCEMETA_JSONSCHEMA_CLI_BINPACK_H_
+
+#include <sourcemeta/blaze/compiler.h>
+#include <sourcemeta/blaze/evaluator.h>
+#include <sourcemeta/blaze/foundation.h>
+#include <sourcemeta/core/json.h>
+#include <sourcemeta/core/options.h>
+
+#include <sourcemeta/jsonbinpack/compiler.h>
+#include <sourcemeta/jsonbinpack/runtime.h>
+
+#include <algorithm>   // std::ranges::all_of
+#include <cassert>     // assert
+#include <cctype>      // std::isdigit
+#include <cstddef>     // std::size_t, std::byte
+#include <cstdint>     // std::uint8_t, std::uint64_t
+#include <filesystem>  // std::filesystem::path
+#include <iostream>    // std::cerr
+#include <istream>     // std::istream
+#include <optional>    // std::optional
+#include <ostream>     // std::ostream
+#include <span>        // std::span
+#include <sstream>     // std::ostringstream
+#include <stdexcept>   // std::out_of_range
+#include <string>      // std::string
+#include <string_view> // std::string_view
+#include <vector>      // std::vector
+
+#include "configuration.h"
+#include "error.h"
+#include "exit_code.h"
+#include "input.h"
+#include "resolver.h"
+#include "timings.h"
+#include "utils.h"
+
+namespace sourcemeta::jsonschema {
+
+// Determine the JSON BinPack encoding for the given command. Without a schema,
+// we fall back to the schema-less encoding, looking for configuration
+// relative to the given document instead. If a validator is requested, it is
+// set to a template for the schema, if any
+inline auto binpack_encoding(
+    const sourcemeta::core::Options &options,
+    const std::filesystem::path &document,
+    std::optional<sourcemeta::blaze::Template> *validator = nullptr)
+    -> sourcemeta::jsonbinpack::Encoding {
+  if (!options.contains("schema") || options.at("schema").empty()) {
+    auto schema{sourcemeta::core::parse_json(R"JSON({
+      "$schema": "https://json-schema.org/draft/2020-12/schema"
+    })JSON")};
+
+    const auto configuration_path{find_configuration(document)};
+    const auto &configuration{read_configuration(options, configuration_path)};
+    const auto dialect{default_dialect(options, configuration)};
+    const auto &custom_resolver{
+        resolver(options, options.contains("http"), dialect, configuration)};
+    sourcemeta::jsonbinpack::compile(schema, sourcemeta::blaze::schema_walker,
+                                     custom_resolver);
+    return sourcemeta::jsonbinpack::load(schema);
+  }
+
+  const std::filesystem::path schema_path{options.at("schema").front()};
+  const auto configuration_path{find_configuration(schema_path)};
+  const auto &configuration{
+      read_configuration(options, configuration_path, schema_path)};
+  const auto dialect{default_dialect(options, configuration)};
+  const auto &custom_resolver{
+      resolver(options, options.contains("http"), dialect, configuration)};
+
+  const auto parsed_schema{read_file(schema_path)};
+  if (!sourcemeta::blaze::is_schema(parsed_schema.document)) {
+    throw NotSchemaError{schema_path};
+  }
+
+  // The encoding compiler does not follow references, so we inline them first
+  auto schema{bundle_for_evaluation(
+      parsed_schema.document, custom_resolver, dialect,
+      sourcemeta::jsonschema::default_id(schema_path, false), schema_path,
+      parsed_schema.positions)};
+
+  const TimingsScope timing{"compile", schema_path};
+  try {
+    // The encoding compiler transforms the schema in place
+    if (validator != nullptr) {
+      *validator = sourcemeta::blaze::compile(
+          schema, sourcemeta::blaze::schema_walker, custom_resolver,
+          sourcemeta::blaze::default_schema_compiler,
+          sourcemeta::blaze::Mode::FastValidation, dialect,
+          sourcemeta::jsonschema::default_id(schema_path, false));
+    }
+
+    sourcemeta::jsonbinpack::compile(schema, sourcemeta::blaze::schema_walker,
+                                     custom_resolver, dialect);
+  } catch (const sourcemeta::blaze::SchemaUnknownBaseDialectError &) {
+    throw sourcemeta::core::FileError<
+        sourcemeta::blaze::SchemaUnknownBaseDialectError>(schema_path);
+  } catch (const sourcemeta::blaze::SchemaError &error) {
+    throw sourcemeta::core::FileError<sourcemeta::blaze::SchemaError>(
+        schema_path, error.what());
+  }
+
+  return sourcemeta::jsonbinpack::load(schema);
+}
+
+// The encodings derived from a schema assume that the input matches it, so
+// encoding a non-conforming document would either hit an assertion or write
+// bytes that cannot be decoded. We report it as `validate --fast` would
+inline auto binpack_check(const sourcemeta::blaze::Template &validator,
+                          const sourcemeta::core::JSON &instance,
+                          const std::filesystem::path &path,
+                          const std::optional<std::size_t> entry) -> void {
+  sourcemeta::blaze::Evaluator evaluator;
+  if (evaluator.validate(validator, instance)) {
+    return;
+  }
+
+  std::cerr << "fail: " << path.string();
+  if (entry.has_value()) {
+    std::cerr << " (entry #" << entry.value() + 1 << ")\n\n";
+    sourcemeta::core::prettify(instance, std::cerr);
+    std::cerr << "\n\n";
+  } else {
+    std::cerr << "\n";
+  }
+
+  std::cerr << "error: Schema validation failure\n";
+  throw Fail{EXIT_EXPECTED_FAILURE};
+}
+
+// JSONL datasets are encoded into a container of independently decodable
+// blocks, so that both sides can work on blocks in parallel and readers can
+// seek to a record range without decoding what comes before it. Every
+// integer is fixed-width little endian:
+//
+//   header: magic[4] version:u8
+//   blocks: (records:u32 size:u64 payload[size])*
+//   index:  (offset:u64 records:u64)* one entry per block
+//   footer: blocks:u64 records:u64 index:u64 magic[4]
+//
+// Each payload is a sequence of records written by its own encoder, as the
+// shared string encodings refer back to earlier offsets in the same stream
+constexpr std::string_view BINPACK_CONTAINER_MAGIC{"JBPK"};
+constexpr std::uint8_t BINPACK_CONTAINER_VERSION{1};
+constexpr std::size_t BINPACK_BLOCK_RECORDS{1024};
+constexpr std::size_t BINPACK_FOOTER_SIZE{8 + 8 + 8 +
+                                          BINPACK_CONTAINER_MAGIC.size()};
+
+struct BinPackBlock {
+  // The offset of the block header from the start of the container
+  std::uint64_t offset;
+  // The index of the first record of the block in the whole dataset
+  std::uint64_t first;
+  std::uint64_t records;
+};
+
+struct BinPackIndex {
+  std::vector<BinPackBlock> blocks;
+  std::uint64_t records;
+  // The offset of the index from the start of the container, which no block
+  // may extend past
+  std::uint64_t position;
+};
+
+inline auto binpack_write_integer(std::ostream &stream,
+                                  const std::uint64_t value,
+                                  const std::size_t width) -> void {
+  for (std::size_t index = 0; index < width; index++) {
+    stream.put(static_cast<char>((value >> (index * 8)) & 0xFF));
+  }
+}
+
+inline auto binpack_read_integer(std::istream &stream,
+                                 const std::filesystem::path &path,
+                                 const std::size_t width) -> std::uint64_t {
+  std::uint64_t result{0};
+  for (std::size_t index = 0; index < width; index++) {
+    const auto character{stream.get()};
+    if (character == std::istream::traits_type::eof()) {
+      throw BinPackContainerError{"The JSON BinPack container is truncated",
+                                  path};
+    }
+
+    result |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(character))
+              << (index * 8);
+  }
+
+  return result;
+}
+
+inline auto binpack_write_header(std::ostream &stream) -> void {
+  stream.write(BINPACK_CONTAINER_MAGIC.data(),
+               static_cast<std::streamsize>(BINPACK_CONTAINER_MAGIC.size()));
+  binpack_write_integer(stream, BINPACK_CONTAINER_VERSION, 1);
+}
+
+inline auto binpack_read_magic(std::istream &stream,
+                               const std::filesystem::path &path) -> void {
+  std::string magic(BINPACK_CONTAINER_MAGIC.size(), '\0');
+  stream.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+  if (!stream || magic != BINPACK_CONTAINER_MAGIC) {
+    throw BinPackContainerError{
+        "The input is not a JSON BinPack container of JSONL records", path};
+  }
+}
+
+inline auto binpack_encode_block(
+    const std::vector<sourcemeta::core::JSON> &records,
+    const sourcemeta::jsonbinpack::Encoding &encoding)
+    -> std::vector<std::byte> {
+  std::vector<std::byte> payload;
+  sourcemeta::jsonbinpack::Encoder encoder{payload};
+  for (const auto &record : records) {
+    encoder.write(record, encoding);
+  }
+
+  return payload;
+}
+
+inline auto binpack_write_block(std::ostream &stream,
+                                const std::uint64_t records,
+                                const std::vector<std::byte> &payload)
+    -> void {
+  binpack_write_integer(stream, records, 4);
+  binpack_write_integer(stream, payload.size(), 8);
+  stream.write(reinterpret_cast<const char *>(payload.data()),
+               static_cast<std::streamsize>(payload.size()));
+}
+
+inline auto binpack_write_index(std::ostream &stream,
+                                const BinPackIndex &index) -> void {
+  const auto position{static_cast<std::uint64_t>(stream.tellp())};
+  for (const auto &block : index.blocks) {
+    binpack_write_integer(stream, block.offset, 8);
+    binpack_write_integer(stream, block.records, 8);
+  }
+
+  binpack_write_integer(stream, index.blocks.size(), 8);
+  binpack_write_integer(stream, index.records, 8);
+  binpack_write_integer(stream, position, 8);
+  stream.write(BINPACK_CONTAINER_MAGIC.data(),
+               static_cast<std::streamsize>(BINPACK_CONTAINER_MAGIC.size()));
+}
+
+// Locate every block through the trailing index, without reading any payload
+inline auto binpack_read_index(std::istream &stream,
+                               const std::filesystem::path &path)
+    -> BinPackIndex {
+  stream.seekg(0, std::ios::end);
+  const auto size{static_cast<std::uint64_t>(stream.tellg())};
+  constexpr auto header_size{BINPACK_CONTAINER_MAGIC.size() + 1};
+  if (size < header_size + BINPACK_FOOTER_SIZE) {
+    throw BinPackContainerError{
+        "The input is not a JSON BinPack container of JSONL records", path};
+  }
+
+  stream.seekg(0);
+  binpack_read_magic(stream, path);
+  if (binpack_read_integer(stream, path, 1) != BINPACK_CONTAINER_VERSION) {
+    throw BinPackContainerError{
+        "The JSON BinPack container version is not supported", path};
+  }
+
+  stream.seekg(static_cast<std::streamoff>(size - BINPACK_FOOTER_SIZE));
+  const auto blocks{binpack_read_integer(stream, path, 8)};
+  const auto records{binpack_read_integer(stream, path, 8)};
+  const auto position{binpack_read_integer(stream, path, 8)};
+  binpack_read_magic(stream, path);
+  // Each index entry takes 16 bytes
+  if (position < header_size || position > size - BINPACK_FOOTER_SIZE ||
+      (size - BINPACK_FOOTER_SIZE - position) / 16 != blocks) {
+    throw BinPackContainerError{"The JSON BinPack container index is corrupted",
+                                path};
+  }
+
+  BinPackIndex result{
+      .blocks = {}, .records = records, .position = position};
+  result.blocks.reserve(blocks);
+  stream.seekg(static_cast<std::streamoff>(position));
+  std::uint64_t first{0};
+  for (std::uint64_t block = 0; block < blocks; block++) {
+    const auto offset{binpack_read_integer(stream, path, 8)};
+    const auto count{binpack_read_integer(stream, path, 8)};
+    if (offset < header_size || offset >= position) {
+      throw BinPackContainerError{
+          "The JSON BinPack container index is corrupted", path};
+    }
+
+    result.blocks.push_back(
+        {.offset = offset, .first = first, .records = count});
+    first += count;
+  }
+
+  if (first != records) {
+    throw BinPackContainerError{"The JSON BinPack container index is corrupted",
+                                path};
+  }
+
+  return result;
+}
+
+// Read the payload of a block, checking its header against the index
+inline auto binpack_read_block(std::istream &stream,
+                               const std::filesystem::path &path,
+                               const BinPackIndex &index,
+                               const BinPackBlock &block)
+    -> std::vector<std::byte> {
+  // Each block header takes 12 bytes
+  constexpr std::uint64_t header_size{4 + 8};
+  if (block.offset > index.position ||
+      index.position - block.offset < header_size) {
+    throw BinPackContainerError{"The JSON BinPack container index is corrupted",
+                                path};
+  }
+
+  stream.seekg(static_cast<std::streamoff>(block.offset));
+  const auto records{binpack_read_integer(stream, path, 4)};
+  const auto size{binpack_read_integer(stream, path, 8)};
+  // Never trust the size of the payload to allocate for it, as the index
+  // already tells us where the payload has to end
+  if (records != block.records ||
+      size > index.position - block.offset - header_size) {
+    throw BinPackContainerError{"The JSON BinPack container index is corrupted",
+                                path};
+  }
+
+  std::vector<std::byte> payload(size);
+  stream.read(reinterpret_cast<char *>(payload.data()),
+              static_cast<std::streamsize>(size));
+  if (!stream) {
+    throw BinPackContainerError{"The JSON BinPack container is truncated",
+                                path};
+  }
+
+  return payload;
+}
+
+// Records that precede a requested range still have to be decoded, as every
+// record starts where the previous one ended, but nothing is done with them
+class BinPackSkipVisitor final
+    : public sourcemeta::jsonbinpack::DecoderVisitor {
+public:
+  auto value(const sourcemeta::core::JSON &) -> void override {}
+  auto array_start(const std::uint64_t) -> void override {}
+  auto array_end() -> void override {}
+  auto object_start() -> void override {}
+  auto property(const sourcemeta::core::JSON::String &) -> void override {}
+  auto object_end() -> void override {}
+};
+
+// Decode the records of a block straight into prettified JSON text, without
+// materialising every record as a JSON document first
+inline auto binpack_decode_block(
+    const std::span<const std::byte> payload, const std::uint64_t records,
+    const std::uint64_t skip, const sourcemeta::jsonbinpack::Encoding &encoding)
+    -> std::vector<std::string> {
+  assert(skip <= records);
+  sourcemeta::jsonbinpack::Decoder decoder{payload};
+  BinPackSkipVisitor skipper;
+  for (std::uint64_t record = 0; record < skip; record++) {
+    decoder.read(encoding, skipper);
+  }
+
+  std::vector<std::string> result;
+  result.reserve(records - skip);
+  std::ostringstream buffer;
+  for (std::uint64_t record = skip; record < records; record++) {
+    buffer.str("");
+    sourcemeta::jsonbinpack::DecoderWriter writer{buffer, true};
+    decoder.read(encoding, writer);
+    result.push_back(buffer.str());
+  }
+
+  return result;
+}
+
+inline auto parse_record_option(const sourcemeta::core::Options &options,
+                                const std::string_view name)
+    -> std::optional<std::uint64_t> {
+  if (!options.contains(name) || options.at(name).empty()) {
+    return std::nullopt;
+  }
+
+  const std::string value{options.at(name).front()};
+  if (value.empty() || !std::ranges::all_of(value, [](const char character) {
+        return std::isdigit(static_cast<unsigned char>(character));
+      })) {
+    throw InvalidRecordRangeError{};
+  }
+
+  try {
+    return std::stoull(value);
+  } catch (const std::out_of_range &) {
+    throw InvalidRecordRangeError{};
+  }
+}
+
+} // namespace sourcemeta::jsonschema
+
+#endif
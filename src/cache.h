@@ -0,0 +1,228 @@
+#ifndef SOURCEMETA_JSONSCHEMA_CLI_CACHE_H_
+#define SOURCEMETA_JSONSCHEMA_CLI_CACHE_H_
+
+#include <sourcemeta/core/crypto.h>
+#include <sourcemeta/core/io.h>
+#include <sourcemeta/core/json.h>
+#include <sourcemeta/core/options.h>
+
+#include "configuration.h"
+#include "configure.h"
+#include "logger.h"
+
+#include <cstddef>     // std::size_t
+#include <filesystem>  // std::filesystem
+#include <map>         // std::map
+#include <optional>    // std::optional
+#include <ostream>     // std::ostream
+#include <set>         // std::set
+#include <string>      // std::string
+#include <string_view> // std::string_view
+#include <utility>     // std::move
+
+namespace sourcemeta::jsonschema {
+
+// An opt-in manifest, enabled with `--cache <path>`, of the files that a
+// command found clean in previous runs. Files are keyed by a hash of their
+// contents, the contents of their configuration file, the version of the CLI,
+// and every option that affects the outcome of the command, so that later
+// runs can skip unchanged files without parsing them. A single manifest may
+// be shared between commands, as each command gets its own section
+class ResultCache {
+public:
+  ResultCache(const sourcemeta::core::Options &options,
+              const std::string_view command)
+      : options_{options}, command_{command} {
+    if (options.contains("cache") && !options.at("cache").empty()) {
+      this->path_ = sourcemeta::core::weakly_canonical(
+          std::filesystem::path{options.at("cache").front()});
+    }
+
+    this->depend(PROJECT_VERSION);
+    this->depend(command);
+    // The global options that may change the outcome of any command
+    this->depend_on_option("default-dialect");
+    this->depend_on_option("resolve");
+    this->depend_on_option("http");
+  }
+
+  [[nodiscard]] auto enabled() const noexcept -> bool {
+    return this->path_.has_value();
+  }
+
+  // Fold anything else that affects the outcome of the command into the key
+  // of every file. This must happen before querying the cache
+  auto depend(const std::string_view value) -> void {
+    this->settings_.append(value);
+    this->settings_.push_back('\0');
+  }
+
+  auto depend_on_option(const std::string_view name) -> void {
+    this->depend(name);
+    if (this->options_.contains(name)) {
+      for (const auto &value : this->options_.at(name)) {
+        this->depend(value);
+      }
+    }
+  }
+
+  auto depend_on_file(const std::filesystem::path &path) -> void {
+    this->depend(path.generic_string());
+    if (std::filesystem::is_regular_file(path)) {
+      this->depend(sourcemeta::core::read_file_to_string(path));
+    }
+  }
+
+  // Whether the file is unchanged since the command last found it clean
+  auto clean(const std::filesystem::path &path) -> bool {
+    if (!this->enabled() || !std::filesystem::is_regular_file(path)) {
+      return false;
+    }
+
+    this->load();
+    const auto key{path.generic_string()};
+    const auto match{this->files_.find(key)};
+    if (match == this->files_.cend() || match->second != this->digest(path)) {
+      return false;
+    }
+
+    LOG_VERBOSE(this->options_) << "Skipping unchanged file: " << key << "\n";
+    this->skipped_ += 1;
+    return true;
+  }
+
+  // Record whether the command found an entry of the given file to be clean.
+  // A file with more than one entry is clean only if every entry is
+  auto record(const std::filesystem::path &path, const bool clean) -> void {
+    if (!this->enabled()) {
+      return;
+    }
+
+    const auto key{path.generic_string()};
+    if (!clean) {
+      this->dirty_.insert(key);
+      this->processed_.erase(key);
+    } else if (!this->dirty_.contains(key)) {
+      this->processed_.insert(key);
+    }
+  }
+
+  // How many files the command did not have to process
+  [[nodiscard]] auto skipped() const noexcept -> std::size_t {
+    return this->skipped_;
+  }
+
+  auto save() -> void {
+    if (!this->enabled()) {
+      return;
+    }
+
+    this->load();
+    for (const auto &key : this->dirty_) {
+      this->files_.erase(key);
+    }
+
+    // We hash files again, as commands may have rewritten them
+    for (const auto &key : this->processed_) {
+      const std::filesystem::path path{key};
+      if (std::filesystem::is_regular_file(path)) {
+        this->files_.insert_or_assign(key, this->digest(path));
+      }
+    }
+
+    auto files{sourcemeta::core::JSON::make_object()};
+    for (const auto &[key, value] : this->files_) {
+      files.assign(key, sourcemeta::core::JSON{value});
+    }
+
+    this->manifest_.assign(this->command_, std::move(files));
+    if (this->path_.value().has_parent_path()) {
+      std::filesystem::create_directories(this->path_.value().parent_path());
+    }
+
+    sourcemeta::core::atomic_write_file(
+        this->path_.value(), [this](std::ostream &stream) -> void {
+          sourcemeta::core::prettify(this->manifest_, stream);
+          stream << "\n";
+        });
+  }
+
+private:
+  auto load() -> void {
+    if (this->loaded_) {
+      return;
+    }
+
+    this->loaded_ = true;
+    this->settings_digest_ = sourcemeta::core::sha256(this->settings_);
+    this->manifest_ = sourcemeta::core::JSON::make_object();
+    if (!std::filesystem::exists(this->path_.value())) {
+      return;
+    }
+
+    try {
+      auto manifest{sourcemeta::core::read_json(this->path_.value())};
+      if (manifest.is_object()) {
+        this->manifest_ = std::move(manifest);
+      }
+    } catch (const sourcemeta::core::JSONParseError &) {
+      LOG_WARNING() << "Ignoring invalid cache manifest: "
+                    << this->path_.value().generic_string() << "\n";
+    }
+
+    if (!this->manifest_.defines(this->command_) ||
+        !this->manifest_.at(this->command_).is_object()) {
+      return;
+    }
+
+    for (const auto &entry : this->manifest_.at(this->command_).as_object()) {
+      if (entry.second.is_string()) {
+        this->files_.emplace(entry.first, entry.second.to_string());
+      }
+    }
+  }
+
+  auto digest(const std::filesystem::path &path) -> std::string {
+    std::string input{this->settings_digest_};
+    input.push_back('\0');
+    const auto configuration_path{find_configuration(path)};
+    if (configuration_path.has_value()) {
+      const auto configuration_key{configuration_path.value().generic_string()};
+      auto match{this->configurations_.find(configuration_key)};
+      if (match == this->configurations_.end()) {
+        match =
+            this->configurations_
+                .emplace(configuration_key,
+                         sourcemeta::core::sha256(
+                             sourcemeta::core::read_file_to_string(
+                                 configuration_path.value())))
+                .first;
+      }
+
+      input.append(configuration_key);
+      input.push_back('\0');
+      input.append(match->second);
+    }
+
+    input.push_back('\0');
+    input.append(sourcemeta::core::read_file_to_string(path));
+    return sourcemeta::core::sha256(input);
+  }
+
+  const sourcemeta::core::Options &options_;
+  const std::string command_;
+  std::optional<std::filesystem::path> path_;
+  std::string settings_;
+  std::string settings_digest_;
+  bool loaded_{false};
+  sourcemeta::core::JSON manifest_{nullptr};
+  std::map<std::string, std::string> files_;
+  std::map<std::string, std::string> configurations_;
+  std::set<std::string> processed_;
+  std::set<std::string> dirty_;
+  std::size_t skipped_{0};
+};
+
+} // namespace sourcemeta::jsonschema
+
+#endif
@@ -18,6 +18,7 @@ auto codegen(const sourcemeta::core::Options &options) -> void;
 auto install(const sourcemeta::core::Options &options) -> void;
 auto upgrade(const sourcemeta::core::Options &options) -> void;
 auto rdf(const sourcemeta::core::Options &options) -> void;
+auto openapi(const sourcemeta::core::Options &options) -> void;
 } // namespace sourcemeta::jsonschema
 
 #endif
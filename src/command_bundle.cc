@@ -14,6 +14,7 @@
 #include "input.h"
 #include "logger.h"
 #include "resolver.h"
+#include "timings.h"
 #include "utils.h"
 
 auto sourcemeta::jsonschema::bundle(const sourcemeta::core::Options &options)
@@ -53,6 +54,7 @@ auto sourcemeta::jsonschema::bundle(const sourcemeta::core::Options &options)
   const auto &custom_resolver{
       resolver(options, options.contains("http"), dialect, configuration)};
 
+  const TimingsScope timing{"bundle", schema_display_path};
   try {
     sourcemeta::blaze::bundle(
         schema, sourcemeta::blaze::schema_walker, custom_resolver,
@@ -17,6 +17,7 @@
 #include "configuration.h"
 #include "error.h"
 #include "resolver.h"
+#include "timings.h"
 #include "utils.h"
 
 auto sourcemeta::jsonschema::compile(const sourcemeta::core::Options &options)
@@ -49,6 +50,7 @@ auto sourcemeta::jsonschema::compile(const sourcemeta::core::Options &options)
       sourcemeta::jsonschema::default_id(schema_path, false)};
 
   sourcemeta::blaze::Template schema_template;
+  const TimingsScope timing{"compile", schema_path};
   try {
     if (options.contains("entrypoint") && !options.at("entrypoint").empty()) {
       const sourcemeta::core::JSON bundled{sourcemeta::blaze::bundle(
@@ -1,34 +1,31 @@
-#include <sourcemeta/blaze/foundation.h>
 #include <sourcemeta/core/io.h>
 #include <sourcemeta/core/json.h>
+#include <sourcemeta/core/parallel.h>
+
+// The parallel module includes windows.h, which defines DELETE as a macro
+// that would otherwise break parsing the HTTPMethod enumeration that the
+// resolver transitively includes below
+#if defined(_WIN32)
+#undef DELETE
+#endif
 
-#include <sourcemeta/jsonbinpack/compiler.h>
 #include <sourcemeta/jsonbinpack/runtime.h>
 
+#include <algorithm>  // std::min
 #include <cassert>    // assert
+#include <cstddef>    // std::size_t, std::byte
+#include <cstdint>    // std::uint64_t
 #include <filesystem> // std::filesystem
-#include <fstream>    // std::ifstream
+#include <fstream>    // std::ifstream, std::ofstream
+#include <string>     // std::string
+#include <vector>     // std::vector
 
+#include "binpack.h"
 #include "command.h"
-#include "configuration.h"
 #include "error.h"
 #include "logger.h"
-#include "resolver.h"
 #include "utils.h"
 
-static auto has_data(std::ifstream &stream) -> bool {
-  if (!stream.is_open()) {
-    return false;
-  }
-
-  std::streampos current_pos = stream.tellg();
-  stream.seekg(0, std::ios::end);
-  std::streampos end_pos = stream.tellg();
-  stream.seekg(current_pos);
-
-  return (current_pos < end_pos) && stream.good();
-}
-
 auto sourcemeta::jsonschema::decode(const sourcemeta::core::Options &options)
     -> void {
   if (options.positional().size() < 2) {
@@ -39,55 +36,101 @@ auto sourcemeta::jsonschema::decode(const sourcemeta::core::Options &options)
 
   validate_http_headers(options);
 
-  // TODO: Take a real schema as argument
-  auto schema{sourcemeta::core::parse_json(R"JSON({
-    "$schema": "https://json-schema.org/draft/2020-12/schema"
-  })JSON")};
-
-  const auto configuration_path{
-      find_configuration(options.positional().front())};
-  const auto &configuration{read_configuration(options, configuration_path)};
-  const auto dialect{default_dialect(options, configuration)};
-  const auto &custom_resolver{
-      resolver(options, options.contains("http"), dialect, configuration)};
-
-  sourcemeta::jsonbinpack::compile(schema, sourcemeta::blaze::schema_walker,
-                                   custom_resolver);
-  const auto encoding{sourcemeta::jsonbinpack::load(schema)};
-
-  std::ifstream input_stream{
-      sourcemeta::core::weakly_canonical(options.positional().front()),
-      std::ios::binary};
+  const std::filesystem::path output{options.positional().at(1)};
+  const auto from{parse_record_option(options, "from")};
+  const auto count{parse_record_option(options, "count")};
+  if ((from.has_value() || count.has_value()) &&
+      output.extension() != ".jsonl") {
+    throw OptionConflictError{
+        "The --from and --count options only apply to JSONL output"};
+  }
+
+  const auto encoding{binpack_encoding(options, options.positional().front())};
+
+  const auto input{
+      sourcemeta::core::weakly_canonical(options.positional().front())};
+  std::ifstream input_stream{input, std::ios::binary};
   assert(!input_stream.fail());
   assert(input_stream.is_open());
 
-  const std::filesystem::path output{options.positional().at(1)};
   std::ofstream output_stream(sourcemeta::core::weakly_canonical(output),
                               std::ios::binary);
   output_stream.exceptions(std::ios_base::badbit);
-  sourcemeta::jsonbinpack::Decoder decoder{input_stream};
 
   if (output.extension() == ".jsonl") {
     LOG_VERBOSE(options) << "Interpreting input as JSONL: "
-                         << sourcemeta::core::weakly_canonical(
-                                options.positional().front())
-                                .generic_string()
-                         << "\n";
-
-    std::size_t count{0};
-    while (has_data(input_stream)) {
-      LOG_VERBOSE(options) << "Decoding entry #" << count << "\n";
-      auto document{decoder.read(encoding)};
-      if (count > 0) {
-        output_stream << "\n";
+                         << input.generic_string() << "\n";
+
+    const auto index{binpack_read_index(input_stream, input)};
+    const auto begin{std::min(from.value_or(0), index.records)};
+    const auto end{begin + std::min(count.value_or(index.records),
+                                    index.records - begin)};
+
+    struct Block {
+      const BinPackBlock *location;
+      std::vector<std::byte> payload;
+      std::vector<std::string> records;
+    };
+
+    const auto jobs{parse_jobs(options)};
+    std::vector<Block> batch;
+    std::uint64_t cursor{begin};
+    // Only hold as many blocks in memory as we can decode at once
+    const auto flush{[&]() {
+      sourcemeta::core::parallel_for_each(
+          batch.begin(), batch.end(),
+          [&encoding, begin, end](Block &block, const std::size_t,
+                                  const std::size_t) {
+            const auto &location{*block.location};
+            // Records past the range are never needed, but the ones before
+            // it are, as every record starts where the previous one ended
+            const auto needed{std::min(location.records, end - location.first)};
+            const auto skip{
+                begin > location.first ? begin - location.first : 0};
+            block.records =
+                binpack_decode_block(block.payload, needed, skip, encoding);
+          },
+          jobs);
+
+      for (const auto &block : batch) {
+        for (const auto &record : block.records) {
+          LOG_VERBOSE(options) << "Decoding entry #" << cursor << "\n";
+          if (cursor > begin) {
+            output_stream << "\n";
+          }
+
+          output_stream << record;
+          cursor += 1;
+        }
+      }
+
+      batch.clear();
+    }};
+
+    for (const auto &block : index.blocks) {
+      if (block.first + block.records <= begin || block.records == 0) {
+        continue;
+      } else if (block.first >= end) {
+        break;
+      }
+
+      if (batch.size() == jobs) {
+        flush();
       }
 
-      sourcemeta::core::prettify(document, output_stream);
-      count += 1;
+      batch.push_back(
+          {.location = &block,
+           .payload = binpack_read_block(input_stream, input, index, block),
+           .records = {}});
     }
+
+    flush();
   } else {
-    auto document{decoder.read(encoding)};
-    sourcemeta::core::prettify(document, output_stream);
+    // Decode straight out of a memory-mapped view of the input
+    const sourcemeta::core::FileView view{input};
+    sourcemeta::jsonbinpack::Decoder decoder{view};
+    sourcemeta::jsonbinpack::DecoderWriter writer{output_stream, true};
+    decoder.read(encoding, writer);
   }
 
   output_stream << "\n";
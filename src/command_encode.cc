@@ -1,22 +1,32 @@
-#include <sourcemeta/blaze/foundation.h>
 #include <sourcemeta/core/io.h>
 #include <sourcemeta/core/json.h>
 #include <sourcemeta/core/jsonl.h>
+#include <sourcemeta/core/parallel.h>
 #include <sourcemeta/core/yaml.h>
 
-#include <sourcemeta/jsonbinpack/compiler.h>
+// The parallel module includes windows.h, which defines DELETE as a macro
+// that would otherwise break parsing the HTTPMethod enumeration that the
+// resolver transitively includes below
+#if defined(_WIN32)
+#undef DELETE
+#endif
+
+#include <sourcemeta/blaze/evaluator.h>
 #include <sourcemeta/jsonbinpack/runtime.h>
 
+#include <cstddef>    // std::size_t, std::byte
+#include <cstdint>    // std::uint64_t
 #include <filesystem> // std::filesystem
 #include <fstream>    // std::ofstream
+#include <optional>   // std::optional, std::nullopt
 #include <print>      // std::println
+#include <vector>     // std::vector
 
+#include "binpack.h"
 #include "command.h"
-#include "configuration.h"
 #include "error.h"
 #include "input.h"
 #include "logger.h"
-#include "resolver.h"
 #include "utils.h"
 
 auto sourcemeta::jsonschema::encode(const sourcemeta::core::Options &options)
@@ -29,21 +39,9 @@ auto sourcemeta::jsonschema::encode(const sourcemeta::core::Options &options)
 
   validate_http_headers(options);
 
-  // TODO: Take a real schema as argument
-  auto schema{sourcemeta::core::parse_json(R"JSON({
-    "$schema": "https://json-schema.org/draft/2020-12/schema"
-  })JSON")};
-
-  const auto configuration_path{
-      find_configuration(options.positional().front())};
-  const auto &configuration{read_configuration(options, configuration_path)};
-  const auto dialect{default_dialect(options, configuration)};
-  const auto &custom_resolver{
-      resolver(options, options.contains("http"), dialect, configuration)};
-
-  sourcemeta::jsonbinpack::compile(schema, sourcemeta::blaze::schema_walker,
-                                   custom_resolver);
-  const auto encoding{sourcemeta::jsonbinpack::load(schema)};
+  std::optional<sourcemeta::blaze::Template> validator;
+  const auto encoding{
+      binpack_encoding(options, options.positional().front(), &validator)};
 
   const std::filesystem::path document{options.positional().front()};
   const auto original_size{std::filesystem::file_size(document)};
@@ -56,18 +54,87 @@ auto sourcemeta::jsonschema::encode(const sourcemeta::core::Options &options)
         << "\n";
 
     auto stream{sourcemeta::core::read_file(document)};
-    std::ofstream output_stream(
-        sourcemeta::core::weakly_canonical(options.positional().at(1)),
-        std::ios::binary);
+    const auto output_path{
+        sourcemeta::core::weakly_canonical(options.positional().at(1))};
+    std::ofstream output_stream(output_path, std::ios::binary);
     output_stream.exceptions(std::ios_base::badbit);
-    sourcemeta::jsonbinpack::Encoder encoder{output_stream};
+    binpack_write_header(output_stream);
+
+    struct Block {
+      std::vector<sourcemeta::core::JSON> records;
+      std::vector<std::byte> payload;
+      // The first record that does not match the schema, if any
+      std::optional<std::size_t> invalid;
+    };
+
+    const auto jobs{parse_jobs(options)};
+    BinPackIndex index{.blocks = {}, .records = 0, .position = 0};
+    std::vector<Block> batch;
+    // Only hold as many blocks in memory as we can encode at once
+    const auto flush{[&]() {
+      sourcemeta::core::parallel_for_each(
+          batch.begin(), batch.end(),
+          [&encoding, &validator](Block &block, const std::size_t,
+                                  const std::size_t) {
+            if (validator.has_value()) {
+              sourcemeta::blaze::Evaluator evaluator;
+              for (std::size_t record = 0; record < block.records.size();
+                   record++) {
+                if (!evaluator.validate(validator.value(),
+                                        block.records[record])) {
+                  block.invalid = record;
+                  return;
+                }
+              }
+            }
+
+            block.payload = binpack_encode_block(block.records, encoding);
+          },
+          jobs);
+
+      for (const auto &block : batch) {
+        if (block.invalid.has_value()) {
+          // Do not leave a container behind that lacks its index
+          output_stream.close();
+          std::filesystem::remove(output_path);
+          binpack_check(validator.value(),
+                        block.records.at(block.invalid.value()),
+                        sourcemeta::core::weakly_canonical(document),
+                        index.records + block.invalid.value());
+        }
+
+        index.blocks.push_back(
+            {.offset = static_cast<std::uint64_t>(output_stream.tellp()),
+             .first = index.records,
+             .records = block.records.size()});
+        index.records += block.records.size();
+        binpack_write_block(output_stream, block.records.size(),
+                            block.payload);
+      }
+
+      batch.clear();
+    }};
+
     std::size_t count{0};
     for (const auto &entry : sourcemeta::core::JSONL{stream}) {
       LOG_VERBOSE(options) << "Encoding entry #" << count << "\n";
-      encoder.write(entry, encoding);
+      if (batch.empty() ||
+          batch.back().records.size() == BINPACK_BLOCK_RECORDS) {
+        if (batch.size() == jobs) {
+          flush();
+        }
+
+        batch.push_back(
+            {.records = {}, .payload = {}, .invalid = std::nullopt});
+        batch.back().records.reserve(BINPACK_BLOCK_RECORDS);
+      }
+
+      batch.back().records.push_back(entry);
       count += 1;
     }
 
+    flush();
+    binpack_write_index(output_stream, index);
     output_stream.flush();
     const auto total_size{static_cast<std::uint64_t>(output_stream.tellp())};
     output_stream.close();
@@ -77,12 +144,21 @@ auto sourcemeta::jsonschema::encode(const sourcemeta::core::Options &options)
   } else {
     const auto entry{
         sourcemeta::core::read_yaml_or_json(options.positional().front())};
+    if (validator.has_value()) {
+      binpack_check(validator.value(), entry,
+                    sourcemeta::core::weakly_canonical(document), std::nullopt);
+    }
+
+    // Encode in memory and write the result at once
+    std::vector<std::byte> buffer;
+    sourcemeta::jsonbinpack::Encoder encoder{buffer};
+    encoder.write(entry, encoding);
     std::ofstream output_stream(
         sourcemeta::core::weakly_canonical(options.positional().at(1)),
         std::ios::binary);
     output_stream.exceptions(std::ios_base::badbit);
-    sourcemeta::jsonbinpack::Encoder encoder{output_stream};
-    encoder.write(entry, encoding);
+    output_stream.write(reinterpret_cast<const char *>(buffer.data()),
+                        static_cast<std::streamsize>(buffer.size()));
     output_stream.flush();
     const auto total_size{static_cast<std::uint64_t>(output_stream.tellp())};
     output_stream.close();
@@ -4,17 +4,21 @@
 #include <sourcemeta/core/io.h>
 #include <sourcemeta/core/json.h>
 
+#include <algorithm>   // std::find
+#include <filesystem>  // std::filesystem
 #include <iostream>    // std::cerr, std::cout
 #include <sstream>     // std::ostringstream
 #include <string>      // std::string
 #include <string_view> // std::string_view
 #include <utility>     // std::move, std::unreachable
 
+#include "cache.h"
 #include "command.h"
 #include "error.h"
 #include "input.h"
 #include "logger.h"
 #include "resolver.h"
+#include "timings.h"
 #include "utils.h"
 
 namespace {
@@ -93,6 +97,15 @@ auto sourcemeta::jsonschema::fmt(const sourcemeta::core::Options &options)
   auto errors{sourcemeta::core::JSON::make_array()};
   const auto indentation{parse_indentation(options)};
 
+  // Checking and formatting agree on what a formatted file is
+  ResultCache cache{options, "fmt"};
+  cache.depend_on_option("keep-ordering");
+  cache.depend_on_option("indentation");
+  const auto skip{[&cache](const std::filesystem::path &path) {
+    return cache.clean(path);
+  }};
+  const auto shard{parse_shard(options)};
+
   const auto handle_stdin = [&]() {
     const auto current_path{std::filesystem::current_path()};
     const auto configuration_path{find_configuration(current_path)};
@@ -198,6 +211,8 @@ auto sourcemeta::jsonschema::fmt(const sourcemeta::core::Options &options)
       LOG_VERBOSE(options) << "Formatting: " << entry.first << "\n";
     }
 
+    const TimingsScope timing{"format", entry.resolution_base};
+
     try {
       const auto configuration_path{find_configuration(entry.resolution_base)};
       const auto &configuration{read_configuration(options, configuration_path,
@@ -230,9 +245,11 @@ auto sourcemeta::jsonschema::fmt(const sourcemeta::core::Options &options)
       if (options.contains("check")) {
         if (current == expected.str()) {
           LOG_VERBOSE(options) << "ok: " << entry.first << "\n";
+          cache.record(entry.resolution_base, true);
         } else {
           report_check_failure(current, expected.str(), entry.first,
                                output_json, errors);
+          cache.record(entry.resolution_base, false);
           result = false;
         }
       } else {
@@ -240,6 +257,8 @@ auto sourcemeta::jsonschema::fmt(const sourcemeta::core::Options &options)
           sourcemeta::core::atomic_write_file(entry.resolution_base,
                                               expected.str());
         }
+
+        cache.record(entry.resolution_base, true);
       }
     } catch (const sourcemeta::blaze::SchemaKeywordError &error) {
       throw sourcemeta::core::FileError<sourcemeta::blaze::SchemaKeywordError>(
@@ -285,22 +304,31 @@ auto sourcemeta::jsonschema::fmt(const sourcemeta::core::Options &options)
   // When no positional arguments are given, default to for_each_json(options)
   // which scans the current directory.
   if (options.positional().empty()) {
-    for (const auto &entry : for_each_json(options)) {
+    for (const auto &entry : for_each_json(options, skip, shard)) {
       handle_file_entry(entry);
     }
   } else {
     check_no_duplicate_stdin(options.positional());
+    if (shard.has_value() &&
+        std::find(options.positional().cbegin(), options.positional().cend(),
+                  "-") != options.positional().cend()) {
+      throw OptionConflictError{
+          "The `--shard` option cannot be used with standard input"};
+    }
+
     for (const auto &arg : options.positional()) {
       if (arg == "-") {
         handle_stdin();
       } else {
-        for (const auto &entry : for_each_json({arg}, options)) {
+        for (const auto &entry : for_each_json({arg}, options, skip, shard)) {
           handle_file_entry(entry);
         }
       }
     }
   }
 
+  cache.save();
+
   if (options.contains("check") && output_json) {
     auto output_json_object{sourcemeta::core::JSON::make_object()};
     output_json_object.assign("valid", sourcemeta::core::JSON{result});
@@ -16,13 +16,16 @@
 #include <ostream>    // std::ostream
 #include <sstream>    // std::ostringstream
 
+#include "cache.h"
 #include "command.h"
 #include "configuration.h"
 #include "error.h"
 #include "input.h"
 #include "logger.h"
 #include "resolver.h"
+#include "timings.h"
 #include "utils.h"
+#include "watch.h"
 
 static const sourcemeta::core::JSON::String EXCLUDE_KEYWORD{"x-lint-exclude"};
 
@@ -212,6 +215,7 @@ load_rules_from_options(sourcemeta::blaze::SchemaTransformer &bundle,
         std::filesystem::weakly_canonical(rule_path_string)};
     sourcemeta::jsonschema::LOG_VERBOSE(options)
         << "Loading custom rule: " << rule_path.generic_string() << "\n";
+    sourcemeta::jsonschema::Watch::instance().depend_globally(rule_path);
     const auto configuration_path{
         sourcemeta::jsonschema::find_configuration(rule_path)};
     const auto &configuration{sourcemeta::jsonschema::read_configuration(
@@ -230,6 +234,13 @@ auto sourcemeta::jsonschema::lint(const sourcemeta::core::Options &options)
   validate_http_headers(options);
   const bool output_json = options.contains("json");
 
+  ResultCache cache{options, "lint"};
+  for (const auto *name :
+       {"exclude", "only", "fix", "format", "keep-ordering", "indentation",
+        "format-assertion"}) {
+    cache.depend_on_option(name);
+  }
+
   sourcemeta::blaze::SchemaTransformer bundle;
   sourcemeta::blaze::add(bundle, sourcemeta::blaze::AlterSchemaMode::Linter);
 
@@ -286,6 +297,8 @@ auto sourcemeta::jsonschema::lint(const sourcemeta::core::Options &options)
     for (const auto &rule : configuration.value().lint.rules) {
       LOG_VERBOSE(options) << "Loading custom rule from configuration: "
                            << rule.path.generic_string() << "\n";
+      cache.depend_on_file(rule.path);
+      Watch::instance().depend_globally(rule.path);
       load_rule(bundle, rule_names, rule.path, dialect, custom_resolver,
                 sourcemeta::jsonschema::format_assertion_tweaks(options),
                 rule.top_level ? sourcemeta::blaze::SchemaRule::Scope::TopLevel
@@ -293,6 +306,15 @@ auto sourcemeta::jsonschema::lint(const sourcemeta::core::Options &options)
     }
   }
 
+  for (const auto *name : {"rule", "top-level-rule"}) {
+    cache.depend(name);
+    if (options.contains(name)) {
+      for (const auto &rule_path : options.at(name)) {
+        cache.depend_on_file(std::filesystem::weakly_canonical(rule_path));
+      }
+    }
+  }
+
   if (options.contains("rule")) {
     load_rules_from_options(bundle, rule_names, options, "rule",
                             sourcemeta::blaze::SchemaRule::Scope::All);
@@ -381,9 +403,14 @@ auto sourcemeta::jsonschema::lint(const sourcemeta::core::Options &options)
   auto errors_array = sourcemeta::core::JSON::make_array();
   std::vector<std::uint8_t> scores;
   const auto indentation{parse_indentation(options)};
+  const auto &watch{Watch::instance()};
+  const auto skip{[&cache, &watch](const std::filesystem::path &path) {
+    return !watch.affected(path) || cache.clean(path);
+  }};
+  const auto shard{parse_shard(options)};
 
   if (options.contains("fix")) {
-    const auto entries = for_each_json(options);
+    const auto entries = for_each_json(options, skip, shard);
 
     for (const auto &entry : entries) {
       const auto configuration_path{find_configuration(entry.resolution_base)};
@@ -394,6 +421,8 @@ auto sourcemeta::jsonschema::lint(const sourcemeta::core::Options &options)
       const auto &custom_resolver{
           resolver(options, options.contains("http"), dialect, configuration)};
       LOG_VERBOSE(options) << "Linting: " << entry.first << "\n";
+      const TimingsScope timing{"lint", entry.resolution_base};
+      const WatchScope watch_scope{entry.resolution_base};
       if (entry.yaml) {
         throw YAMLInputError{
             "The --fix option is not supported for YAML input files",
@@ -540,6 +569,10 @@ auto sourcemeta::jsonschema::lint(const sourcemeta::core::Options &options)
           result = false;
         }
 
+        if (!entry.from_stdin) {
+          cache.record(entry.resolution_base, wrapper_result == EXIT_SUCCESS);
+        }
+
         if (entry.from_stdin) {
           if (format_output) {
             if (!keep_ordering) {
@@ -580,7 +613,7 @@ auto sourcemeta::jsonschema::lint(const sourcemeta::core::Options &options)
       }
     }
   } else {
-    for (const auto &entry : for_each_json(options)) {
+    for (const auto &entry : for_each_json(options, skip, shard)) {
       const auto configuration_path{find_configuration(entry.resolution_base)};
       const auto &configuration{read_configuration(options, configuration_path,
                                                    entry.resolution_base)};
@@ -588,6 +621,8 @@ auto sourcemeta::jsonschema::lint(const sourcemeta::core::Options &options)
       const auto &custom_resolver{
           resolver(options, options.contains("http"), dialect, configuration)};
       LOG_VERBOSE(options) << "Linting: " << entry.first << "\n";
+      const TimingsScope timing{"lint", entry.resolution_base};
+      const WatchScope watch_scope{entry.resolution_base};
 
       bool printed_progress{false};
       const auto wrapper_result =
@@ -664,9 +699,18 @@ auto sourcemeta::jsonschema::lint(const sourcemeta::core::Options &options)
       } else if (wrapper_result != EXIT_SUCCESS) {
         throw Fail{wrapper_result};
       }
+
+      if (!entry.from_stdin) {
+        cache.record(entry.resolution_base, wrapper_result == EXIT_SUCCESS);
+      }
     }
   }
 
+  cache.save();
+  // Skipped files had no linting issues, so they are perfectly healthy
+  scores.insert(scores.end(), cache.skipped(),
+                static_cast<std::uint8_t>(100));
+
   if (output_json) {
     std::sort(errors_array.as_array().begin(), errors_array.as_array().end(),
               [](const sourcemeta::core::JSON &left,
@@ -8,19 +8,57 @@
 #include <sourcemeta/blaze/evaluator.h>
 #include <sourcemeta/blaze/output.h>
 
-#include <cassert>  // assert
-#include <iostream> // std::cout, std::cerr
-#include <map>      // std::map
-#include <string>   // std::string
-
+#include <cassert>    // assert
+#include <filesystem> // std::filesystem
+#include <iostream>   // std::cout, std::cerr
+#include <map>        // std::map
+#include <optional>   // std::optional
+#include <string>     // std::string
+#include <utility>    // std::move
+
+#include "cache.h"
 #include "command.h"
 #include "configuration.h"
 #include "error.h"
 #include "input.h"
 #include "logger.h"
+#include "metaschemas.h"
 #include "resolver.h"
+#include "timings.h"
 #include "utils.h"
 
+namespace {
+
+struct MetaschemaTemplates {
+  // Only available for precompiled metaschemas
+  std::optional<sourcemeta::blaze::Template> fast;
+  sourcemeta::blaze::Template exhaustive;
+};
+
+auto precompiled_templates(const sourcemeta::core::JSON &metaschema,
+                           const sourcemeta::blaze::SchemaResolver &resolver)
+    -> std::optional<MetaschemaTemplates> {
+  const auto identifier{sourcemeta::blaze::identify(metaschema, resolver)};
+  // The configuration file might resolve an official URI to something else
+  if (identifier.empty() ||
+      sourcemeta::blaze::schema_resolver(identifier) != metaschema) {
+    return std::nullopt;
+  }
+
+  auto fast{sourcemeta::jsonschema::precompiled_metaschema(
+      identifier, sourcemeta::blaze::Mode::FastValidation)};
+  auto exhaustive{sourcemeta::jsonschema::precompiled_metaschema(
+      identifier, sourcemeta::blaze::Mode::Exhaustive)};
+  if (!fast.has_value() || !exhaustive.has_value()) {
+    return std::nullopt;
+  }
+
+  return MetaschemaTemplates{.fast = std::move(fast),
+                             .exhaustive = std::move(exhaustive).value()};
+}
+
+} // namespace
+
 auto sourcemeta::jsonschema::metaschema(
     const sourcemeta::core::Options &options) -> void {
   validate_http_headers(options);
@@ -30,9 +68,20 @@ auto sourcemeta::jsonschema::metaschema(
   bool result{true};
   sourcemeta::blaze::Evaluator evaluator;
 
-  std::map<std::string, sourcemeta::blaze::Template> cache;
+  const auto tweaks{sourcemeta::jsonschema::format_assertion_tweaks(options)};
+  std::map<std::string, MetaschemaTemplates> cache;
+
+  ResultCache results{options, "metaschema"};
+  results.depend_on_option("format-assertion");
+  // Trace and JSON output report on every file, so we cannot skip any
+  const auto skip{[&results](const std::filesystem::path &path) {
+    return results.clean(path);
+  }};
 
-  for (const auto &entry : for_each_json(options)) {
+  const auto shard{parse_shard(options)};
+  for (const auto &entry : for_each_json(
+           options, trace || json_output ? InputSkip{} : InputSkip{skip},
+           shard)) {
     if (!sourcemeta::blaze::is_schema(entry.second)) {
       throw NotSchemaError{entry.from_stdin ? stdin_path()
                                             : entry.resolution_base};
@@ -47,6 +96,7 @@ auto sourcemeta::jsonschema::metaschema(
                                          default_dialect_option,
                                          configuration)};
 
+    const TimingsScope timing{"metaschema", entry.resolution_base};
     try {
       const auto dialect{
           sourcemeta::blaze::dialect(entry.second, default_dialect_option)};
@@ -58,36 +108,54 @@ auto sourcemeta::jsonschema::metaschema(
 
       const auto metaschema{sourcemeta::blaze::metaschema(
           entry.second, custom_resolver, default_dialect_option)};
-      const sourcemeta::core::JSON bundled{sourcemeta::blaze::bundle(
-          metaschema, sourcemeta::blaze::schema_walker, custom_resolver,
-          sourcemeta::blaze::BundleMode::References, default_dialect_option)};
+
+      if (!cache.contains(std::string{dialect}) && !tweaks.has_value()) {
+        auto precompiled{precompiled_templates(metaschema, custom_resolver)};
+        if (precompiled.has_value()) {
+          LOG_DEBUG(options)
+              << "Using precompiled metaschema template: " << dialect << "\n";
+          cache.emplace(std::string{dialect}, std::move(precompiled).value());
+        }
+      }
+
+      // We only need to analyse the metaschema to compile it, or to report
+      // trace output against its locations
+      std::optional<sourcemeta::core::JSON> bundled;
       sourcemeta::blaze::SchemaFrame frame{
           sourcemeta::blaze::SchemaFrame::Mode::References};
-      frame.analyse(bundled, sourcemeta::blaze::schema_walker, custom_resolver,
-                    default_dialect_option);
+      if (trace || !cache.contains(std::string{dialect})) {
+        bundled.emplace(sourcemeta::blaze::bundle(
+            metaschema, sourcemeta::blaze::schema_walker, custom_resolver,
+            sourcemeta::blaze::BundleMode::References, default_dialect_option));
+        frame.analyse(bundled.value(), sourcemeta::blaze::schema_walker,
+                      custom_resolver, default_dialect_option);
+      }
 
       if (!cache.contains(std::string{dialect})) {
         const auto metaschema_template{sourcemeta::blaze::compile(
-            bundled, sourcemeta::blaze::schema_walker, custom_resolver,
+            bundled.value(), sourcemeta::blaze::schema_walker, custom_resolver,
             sourcemeta::blaze::default_schema_compiler, frame, frame.root(),
-            sourcemeta::blaze::Mode::Exhaustive,
-            sourcemeta::jsonschema::format_assertion_tweaks(options))};
-        cache.insert({std::string{dialect}, metaschema_template});
+            sourcemeta::blaze::Mode::Exhaustive, tweaks)};
+        cache.emplace(std::string{dialect},
+                      MetaschemaTemplates{.fast = std::nullopt,
+                                          .exhaustive = metaschema_template});
       }
 
+      const auto &templates{cache.at(std::string{dialect})};
+
       if (trace) {
         sourcemeta::blaze::TraceOutput output{
             sourcemeta::blaze::schema_walker, custom_resolver,
             trace_callback(entry.positions, std::cout),
             sourcemeta::core::EMPTY_WEAK_POINTER, frame};
-        result = evaluator.validate(cache.at(std::string{dialect}),
-                                    entry.second, std::ref(output));
+        result = evaluator.validate(templates.exhaustive, entry.second,
+                                    std::ref(output));
       } else if (json_output) {
         // Otherwise its impossible to correlate the output
         // when validating i.e. a directory of schemas
         std::cerr << entry.first << "\n";
         const auto output{sourcemeta::blaze::standard(
-            evaluator, cache.at(std::string{dialect}), entry.second,
+            evaluator, templates.exhaustive, entry.second,
             sourcemeta::blaze::StandardOutput::Basic, entry.positions)};
         assert(output.is_object());
         assert(output.defines("valid"));
@@ -99,14 +167,27 @@ auto sourcemeta::jsonschema::metaschema(
         sourcemeta::core::prettify(output, std::cout);
         std::cout << "\n";
       } else {
+        // The fast template is enough to tell that a schema is valid, which
+        // is the common case, so we only evaluate the exhaustive template to
+        // report errors
+        const auto valid{
+            templates.fast.has_value() &&
+            evaluator.validate(templates.fast.value(), entry.second)};
         sourcemeta::blaze::SimpleOutput output{entry.second};
-        if (evaluator.validate(cache.at(std::string{dialect}), entry.second,
-                               std::ref(output))) {
+        if (valid || evaluator.validate(templates.exhaustive, entry.second,
+                                        std::ref(output))) {
           LOG_VERBOSE(options)
               << "ok: " << entry.first << "\n  matches " << dialect << "\n";
+          if (!entry.from_stdin) {
+            results.record(entry.resolution_base, true);
+          }
         } else {
           std::cerr << "fail: " << entry.first << "\n";
           print(output, entry.positions, std::cerr);
+          if (!entry.from_stdin) {
+            results.record(entry.resolution_base, false);
+          }
+
           result = false;
         }
       }
@@ -150,6 +231,8 @@ auto sourcemeta::jsonschema::metaschema(
     }
   }
 
+  results.save();
+
   if (!result) {
     throw Fail{EXIT_EXPECTED_FAILURE};
   }
@@ -0,0 +1,626 @@
+#include <sourcemeta/blaze/foundation.h>
+
+#include <sourcemeta/blaze/compiler.h>
+#include <sourcemeta/blaze/evaluator.h>
+#include <sourcemeta/blaze/output.h>
+
+#include <sourcemeta/core/io.h>
+#include <sourcemeta/core/json.h>
+#include <sourcemeta/core/jsonl.h>
+#include <sourcemeta/core/jsonpointer.h>
+#include <sourcemeta/core/parallel.h>
+#include <sourcemeta/core/uri.h>
+#include <sourcemeta/core/uritemplate.h>
+
+// The parallel module includes windows.h, which defines DELETE as a macro
+// that would otherwise break parsing the HTTPMethod enumeration that the
+// resolver transitively includes below
+#if defined(_WIN32)
+#undef DELETE
+#endif
+
+#include <algorithm>   // std::ranges::transform
+#include <array>       // std::array
+#include <cctype>      // std::tolower
+#include <cstddef>     // std::size_t
+#include <filesystem>  // std::filesystem
+#include <fstream>     // std::ifstream
+#include <functional>  // std::less
+#include <iostream>    // std::cerr
+#include <limits>      // std::numeric_limits
+#include <map>         // std::map
+#include <optional>    // std::optional, std::nullopt
+#include <sstream>     // std::ostringstream
+#include <string>      // std::string, std::to_string
+#include <string_view> // std::string_view
+#include <utility>     // std::move
+#include <vector>      // std::vector
+
+#include "command.h"
+#include "configuration.h"
+#include "error.h"
+#include "input.h"
+#include "logger.h"
+#include "resolver.h"
+#include "timings.h"
+#include "utils.h"
+
+namespace {
+
+// How many records a single thread validates at once
+constexpr std::size_t TRAFFIC_BLOCK_RECORDS{1024};
+
+constexpr std::array<std::string_view, 9> OPENAPI_METHODS{
+    {"get", "put", "post", "delete", "options", "head", "patch", "trace",
+     "query"}};
+
+// Operation schemas are hoisted next to the component schemas, so we give them
+// a prefix that component names are unlikely to use
+constexpr std::string_view OPERATION_SCHEMA_PREFIX{"x-jsonschema-operation-"};
+
+struct Operation {
+  std::optional<std::size_t> request;
+  // Keyed by status code, status range such as `2XX`, or `default`
+  std::map<std::string, std::size_t, std::less<>> responses;
+};
+
+struct Route {
+  // The router keeps views into both of these
+  std::string path;
+  std::string operation_id;
+  std::map<std::string, Operation, std::less<>> operations;
+};
+
+struct Record {
+  sourcemeta::core::JSON document;
+  std::size_t index;
+};
+
+struct Outcome {
+  bool valid;
+  std::string message;
+};
+
+auto to_lowercase(const std::string_view input) -> std::string {
+  std::string result{input};
+  std::ranges::transform(result, result.begin(), [](const char character) {
+    return static_cast<char>(
+        std::tolower(static_cast<unsigned char>(character)));
+  });
+
+  return result;
+}
+
+// Follow local references between OpenAPI objects, such as from an operation
+// to `components/requestBodies`. Remote references are not supported
+auto follow(const sourcemeta::core::JSON &document,
+            const sourcemeta::core::JSON *value)
+    -> const sourcemeta::core::JSON * {
+  // Guard against reference cycles
+  for (std::size_t depth = 0; depth < 32 && value != nullptr; depth++) {
+    if (!value->is_object() || !value->defines("$ref")) {
+      return value;
+    }
+
+    const auto &reference{value->at("$ref")};
+    if (!reference.is_string() || !reference.to_string().starts_with('#')) {
+      return nullptr;
+    }
+
+    try {
+      value = sourcemeta::core::try_get(
+          document, sourcemeta::core::to_pointer(
+                        std::string_view{reference.to_string()}.substr(1)));
+    } catch (const sourcemeta::core::PointerParseError &) {
+      return nullptr;
+    }
+  }
+
+  return nullptr;
+}
+
+// Prefer `application/json`, then any other JSON-based media type
+auto json_media_schema(const sourcemeta::core::JSON &document,
+                       const sourcemeta::core::JSON &object)
+    -> const sourcemeta::core::JSON * {
+  if (!object.is_object() || !object.defines("content") ||
+      !object.at("content").is_object()) {
+    return nullptr;
+  }
+
+  const auto &content{object.at("content")};
+  const sourcemeta::core::JSON *fallback{nullptr};
+  for (const auto &entry : content.as_object()) {
+    const auto media_type{to_lowercase(entry.first)};
+    const auto *media{follow(document, &entry.second)};
+    if (media == nullptr || !media->is_object() || !media->defines("schema")) {
+      continue;
+    } else if (media_type.starts_with("application/json")) {
+      return &media->at("schema");
+    } else if (fallback == nullptr &&
+               (media_type.ends_with("+json") ||
+                media_type.find("+json;") != std::string::npos)) {
+      fallback = &media->at("schema");
+    }
+  }
+
+  return fallback;
+}
+
+// OpenAPI schemas reference each other through the components section of the
+// document, which is not a schema. We hoist component schemas into `$defs`
+// and rewrite the references accordingly
+auto rewrite_references(sourcemeta::core::JSON &value) -> void {
+  static constexpr std::string_view COMPONENTS_PREFIX{"#/components/schemas/"};
+  if (value.is_object()) {
+    if (value.defines("$ref") && value.at("$ref").is_string() &&
+        value.at("$ref").to_string().starts_with(COMPONENTS_PREFIX)) {
+      value.assign("$ref",
+                   sourcemeta::core::JSON{
+                       "#/$defs/" + value.at("$ref").to_string().substr(
+                                        COMPONENTS_PREFIX.size())});
+    }
+
+    // Objects can only be iterated over as constants, but rewriting their
+    // values in place leaves their keys alone
+    for (const auto &entry : value.as_object()) {
+      rewrite_references(value.at(entry.first));
+    }
+  } else if (value.is_array()) {
+    for (auto &item : value.as_array()) {
+      rewrite_references(item);
+    }
+  }
+}
+
+auto openapi_dialect(const sourcemeta::core::JSON &document,
+                     const std::filesystem::path &path) -> std::string {
+  if (!document.is_object() || !document.defines("openapi") ||
+      !document.at("openapi").is_string()) {
+    throw sourcemeta::jsonschema::InvalidOpenAPIError{
+        "The input is not an OpenAPI document", path, {}};
+  }
+
+  // OpenAPI 3.0 and older describe schemas with their own JSON Schema variant
+  const auto &version{document.at("openapi").to_string()};
+  if (!version.starts_with("3.1.") && !version.starts_with("3.2.")) {
+    throw sourcemeta::jsonschema::InvalidOpenAPIError{
+        "Only OpenAPI 3.1 and 3.2 documents are supported", path,
+        sourcemeta::core::Pointer{"openapi"}};
+  }
+
+  if (document.defines("jsonSchemaDialect") &&
+      document.at("jsonSchemaDialect").is_string()) {
+    return document.at("jsonSchemaDialect").to_string();
+  }
+
+  return version.starts_with("3.1.")
+             ? "https://spec.openapis.org/oas/3.1/dialect/base"
+             : "https://spec.openapis.org/oas/3.2/dialect/2025-09-17";
+}
+
+// Gateways log full paths, so we route through the path of the first server
+auto openapi_base_path(const sourcemeta::core::JSON &document) -> std::string {
+  if (!document.defines("servers") || !document.at("servers").is_array() ||
+      document.at("servers").empty() ||
+      !document.at("servers").at(0).is_object() ||
+      !document.at("servers").at(0).defines("url") ||
+      !document.at("servers").at(0).at("url").is_string()) {
+    return "";
+  }
+
+  try {
+    const sourcemeta::core::URI server{
+        document.at("servers").at(0).at("url").to_string()};
+    const auto path{server.path()};
+    if (path.has_value() && path.value().starts_with('/')) {
+      return std::string{path.value()};
+    }
+  } catch (const sourcemeta::core::URIParseError &) {
+    // Server URLs may declare variables that we cannot expand
+  }
+
+  return "";
+}
+
+auto response_template(const Operation &operation,
+                       const sourcemeta::core::JSON &status)
+    -> std::optional<std::size_t> {
+  std::string code;
+  if (status.is_integer()) {
+    code = std::to_string(status.to_integer());
+  } else if (status.is_string()) {
+    code = status.to_string();
+  } else {
+    return std::nullopt;
+  }
+
+  const auto exact{operation.responses.find(code)};
+  if (exact != operation.responses.cend()) {
+    return exact->second;
+  }
+
+  if (code.size() == 3) {
+    const auto range{operation.responses.find(code.substr(0, 1) + "XX")};
+    if (range != operation.responses.cend()) {
+      return range->second;
+    }
+  }
+
+  const auto fallback{operation.responses.find("default")};
+  if (fallback != operation.responses.cend()) {
+    return fallback->second;
+  }
+
+  return std::nullopt;
+}
+
+auto describe(const sourcemeta::core::JSON &record) -> std::string {
+  std::ostringstream result;
+  result << record.at("method").to_string() << " "
+         << record.at("path").to_string();
+  if (record.defines("status")) {
+    result << " -> ";
+    sourcemeta::core::stringify(record.at("status"), result);
+  }
+
+  return result.str();
+}
+
+auto validate_record(const sourcemeta::core::URITemplateRouter &router,
+                     const std::vector<Route> &routes,
+                     const std::vector<sourcemeta::blaze::Template> &templates,
+                     sourcemeta::blaze::Evaluator &evaluator,
+                     const sourcemeta::core::JSON &record, const bool fast_mode,
+                     const bool verbose) -> Outcome {
+  if (!record.is_object() || !record.defines("method") ||
+      !record.at("method").is_string() || !record.defines("path") ||
+      !record.at("path").is_string()) {
+    return {.valid = false,
+            .message = "error: The record is expected to be an object with "
+                       "string method and path properties\n"};
+  }
+
+  const auto &path{record.at("path").to_string()};
+  const auto match{router.match(
+      path.substr(0, path.find_first_of("?#")),
+      [](const auto, const auto, const auto) {})};
+  if (match.first == 0) {
+    return {.valid = false,
+            .message = "error: No path in the OpenAPI document matches " +
+                       describe(record) + "\n"};
+  }
+
+  const auto &route{routes.at(match.first - 1)};
+  const auto operation{
+      route.operations.find(to_lowercase(record.at("method").to_string()))};
+  if (operation == route.operations.cend()) {
+    return {.valid = false,
+            .message = "error: No operation in the OpenAPI document matches " +
+                       describe(record) + "\n  at path " + route.path + "\n"};
+  }
+
+  const auto is_response{record.defines("status")};
+  const auto index{is_response
+                       ? response_template(operation->second,
+                                           record.at("status"))
+                       : operation->second.request};
+  if (!index.has_value() || !record.defines("body")) {
+    return {.valid = true,
+            .message = verbose ? "  matches " + describe(record) +
+                                     " (no schema to validate against)\n"
+                               : ""};
+  }
+
+  const auto &schema_template{templates.at(index.value())};
+  const auto &body{record.at("body")};
+  const std::string kind{is_response ? "response" : "request"};
+  if (fast_mode) {
+    if (evaluator.validate(schema_template, body)) {
+      return {.valid = true,
+              .message = verbose ? "  matches " + describe(record) + " (" +
+                                       kind + " at " + route.path + ")\n"
+                                 : ""};
+    }
+
+    return {.valid = false,
+            .message = "error: The " + kind + " body does not match " +
+                       describe(record) + "\n  at path " + route.path + "\n"};
+  }
+
+  sourcemeta::blaze::SimpleOutput output{body};
+  if (evaluator.validate(schema_template, body, std::ref(output))) {
+    return {.valid = true,
+            .message = verbose ? "  matches " + describe(record) + " (" +
+                                     kind + " at " + route.path + ")\n"
+                               : ""};
+  }
+
+  std::ostringstream message;
+  message << "  " << describe(record) << " (" << kind << " at " << route.path
+          << ")\n";
+  sourcemeta::jsonschema::print(output, sourcemeta::core::PointerPositionTracker{},
+                                message);
+  return {.valid = false, .message = message.str()};
+}
+
+} // namespace
+
+auto sourcemeta::jsonschema::openapi(const sourcemeta::core::Options &options)
+    -> void {
+  if (options.positional().size() != 2) {
+    throw PositionalArgumentError{
+        "This command expects a path to an OpenAPI document and a path to a "
+        "JSONL log of HTTP exchanges",
+        "jsonschema openapi path/to/openapi.json path/to/traffic.jsonl"};
+  }
+
+  validate_http_headers(options);
+
+  const std::filesystem::path document_path{options.positional().at(0)};
+  const std::filesystem::path traffic_path{options.positional().at(1)};
+  const auto traffic_string{traffic_path.string()};
+  if (traffic_path.extension() != ".jsonl" &&
+      !traffic_string.ends_with(".jsonl.gz")) {
+    throw PositionalArgumentError{
+        "The HTTP exchanges must be a JSONL file, optionally compressed "
+        "with GZIP",
+        "jsonschema openapi path/to/openapi.json path/to/traffic.jsonl"};
+  }
+
+  if (std::filesystem::is_directory(document_path)) {
+    throw sourcemeta::core::IOIsADirectoryError{document_path};
+  }
+
+  const auto configuration_path{find_configuration(document_path)};
+  const auto &configuration{
+      read_configuration(options, configuration_path, document_path)};
+  const auto dialect{default_dialect(options, configuration)};
+  const auto &custom_resolver{
+      resolver(options, options.contains("http"), dialect, configuration)};
+  const auto fast_mode{options.contains("fast")};
+  const auto verbose{options.contains("verbose")};
+
+  const auto parsed_document{read_file(document_path)};
+  const auto &document{parsed_document.document};
+  const auto schema_dialect{openapi_dialect(document, document_path)};
+
+  auto schema{sourcemeta::core::JSON::make_object()};
+  schema.assign("$schema", sourcemeta::core::JSON{schema_dialect});
+  auto definitions{sourcemeta::core::JSON::make_object()};
+  if (document.defines("components") && document.at("components").is_object() &&
+      document.at("components").defines("schemas") &&
+      document.at("components").at("schemas").is_object()) {
+    for (const auto &entry :
+         document.at("components").at("schemas").as_object()) {
+      auto copy{entry.second};
+      rewrite_references(copy);
+      definitions.assign(entry.first, std::move(copy));
+    }
+  }
+
+  // Every distinct request or response schema gets its own entry point
+  std::map<const sourcemeta::core::JSON *, std::size_t> schema_indexes;
+  std::vector<std::string> entrypoints;
+  const auto register_schema{
+      [&](const sourcemeta::core::JSON *value) -> std::optional<std::size_t> {
+        if (value == nullptr) {
+          return std::nullopt;
+        }
+
+        const auto match{schema_indexes.find(value)};
+        if (match != schema_indexes.cend()) {
+          return match->second;
+        }
+
+        std::string name{OPERATION_SCHEMA_PREFIX};
+        name += std::to_string(entrypoints.size());
+        while (definitions.defines(name)) {
+          name += "-";
+        }
+
+        auto copy{*value};
+        rewrite_references(copy);
+        definitions.assign(name, std::move(copy));
+        schema_indexes.emplace(value, entrypoints.size());
+        entrypoints.push_back("/$defs/" + name);
+        return entrypoints.size() - 1;
+      }};
+
+  std::vector<Route> routes;
+  if (document.defines("paths") && document.at("paths").is_object()) {
+    for (const auto &path : document.at("paths").as_object()) {
+      const auto *item{follow(document, &path.second)};
+      if (item == nullptr || !item->is_object()) {
+        continue;
+      }
+
+      Route route{.path = path.first,
+                  .operation_id = "path" + std::to_string(routes.size()),
+                  .operations = {}};
+      for (const auto &method : OPENAPI_METHODS) {
+        if (!item->defines(method) || !item->at(method).is_object()) {
+          continue;
+        }
+
+        const auto &definition{item->at(method)};
+        Operation operation;
+        if (definition.defines("requestBody")) {
+          const auto *request_body{
+              follow(document, &definition.at("requestBody"))};
+          if (request_body != nullptr) {
+            operation.request =
+                register_schema(json_media_schema(document, *request_body));
+          }
+        }
+
+        if (definition.defines("responses") &&
+            definition.at("responses").is_object()) {
+          for (const auto &response : definition.at("responses").as_object()) {
+            const auto *response_object{follow(document, &response.second)};
+            if (response_object == nullptr) {
+              continue;
+            }
+
+            const auto index{
+                register_schema(json_media_schema(document, *response_object))};
+            if (index.has_value()) {
+              operation.responses.emplace(response.first, index.value());
+            }
+          }
+        }
+
+        route.operations.emplace(method, std::move(operation));
+      }
+
+      routes.push_back(std::move(route));
+    }
+  }
+
+  if (routes.size() >=
+      std::numeric_limits<sourcemeta::core::URITemplateRouter::Identifier>::
+          max()) {
+    throw InvalidOpenAPIError{"The OpenAPI document declares too many paths",
+                              document_path,
+                              sourcemeta::core::Pointer{"paths"}};
+  }
+
+  schema.assign("$defs", std::move(definitions));
+
+  sourcemeta::core::URITemplateRouter router{openapi_base_path(document)};
+  for (std::size_t index = 0; index < routes.size(); index++) {
+    try {
+      router.add(
+          routes[index].path, routes[index].operation_id,
+          static_cast<sourcemeta::core::URITemplateRouter::Identifier>(index +
+                                                                       1));
+    } catch (const sourcemeta::core::URITemplateRouterInvalidSegmentError
+                 &error) {
+      throw InvalidOpenAPIError{error.what(), document_path,
+                                sourcemeta::core::Pointer{
+                                    "paths", routes[index].path}};
+    } catch (const sourcemeta::core::URITemplateRouterVariableMismatchError
+                 &error) {
+      throw InvalidOpenAPIError{error.what(), document_path,
+                                sourcemeta::core::Pointer{
+                                    "paths", routes[index].path}};
+    }
+  }
+
+  const auto schema_default_id{
+      sourcemeta::jsonschema::default_id(document_path, false)};
+  // Positions refer to the OpenAPI document, not to the schema we derive
+  // from it, so we do not pass them along
+  const sourcemeta::core::PointerPositionTracker positions;
+  const auto bundled{bundle_for_evaluation(schema, custom_resolver,
+                                           schema_dialect, schema_default_id,
+                                           document_path, positions)};
+  sourcemeta::blaze::SchemaFrame frame{
+      sourcemeta::blaze::SchemaFrame::Mode::References};
+  frame_for_evaluation(frame, bundled, custom_resolver, schema_dialect,
+                       schema_default_id, document_path, positions);
+
+  std::vector<sourcemeta::blaze::Template> templates;
+  templates.reserve(entrypoints.size());
+  for (const auto &entrypoint : entrypoints) {
+    templates.push_back(compile_for_evaluation(
+        bundled, custom_resolver, frame, resolve_entrypoint(frame, entrypoint),
+        fast_mode ? sourcemeta::blaze::Mode::FastValidation
+                  : sourcemeta::blaze::Mode::Exhaustive,
+        format_assertion_tweaks(options), document_path, positions));
+  }
+
+  LOG_VERBOSE(options) << "Compiled " << templates.size()
+                       << " request and response schemas across "
+                       << routes.size() << " paths\n";
+
+  const auto traffic_canonical{
+      sourcemeta::core::weakly_canonical(traffic_path).generic_string()};
+  const auto gzip{traffic_string.ends_with(".jsonl.gz")};
+  std::ifstream stream{sourcemeta::core::canonical(traffic_path),
+                       std::ios::binary};
+  stream.exceptions(std::ifstream::badbit);
+
+  const auto jobs{parse_jobs(options)};
+  bool result{true};
+  std::vector<std::vector<Record>> batch;
+  std::vector<std::vector<Outcome>> outcomes;
+  // Only hold as many blocks in memory as we can validate at once
+  const auto flush{[&]() {
+    outcomes.resize(batch.size());
+    const TimingsScope timing{"evaluate", traffic_path};
+    std::vector<std::size_t> blocks(batch.size());
+    for (std::size_t index = 0; index < blocks.size(); index++) {
+      blocks[index] = index;
+    }
+
+    sourcemeta::core::parallel_for_each(
+        blocks.begin(), blocks.end(),
+        [&](const std::size_t block, const std::size_t, const std::size_t) {
+          sourcemeta::blaze::Evaluator evaluator;
+          auto &block_outcomes{outcomes[block]};
+          block_outcomes.clear();
+          block_outcomes.reserve(batch[block].size());
+          for (const auto &record : batch[block]) {
+            block_outcomes.push_back(
+                validate_record(router, routes, templates, evaluator,
+                                record.document, fast_mode, verbose));
+          }
+        },
+        jobs);
+
+    // Report in the same order as the log
+    for (std::size_t block = 0; block < batch.size(); block++) {
+      for (std::size_t index = 0; index < batch[block].size(); index++) {
+        const auto &outcome{outcomes[block][index]};
+        const auto entry{batch[block][index].index + 1};
+        if (outcome.valid) {
+          LOG_VERBOSE(options) << "ok: " << traffic_canonical << " (entry #"
+                               << entry << ")\n"
+                               << outcome.message;
+        } else {
+          result = false;
+          std::cerr << "fail: " << traffic_canonical << " (entry #" << entry
+                    << ")\n"
+                    << outcome.message;
+        }
+      }
+    }
+
+    batch.clear();
+  }};
+
+  std::size_t count{0};
+  try {
+    for (const auto &record : sourcemeta::core::JSONL{
+             stream, gzip ? sourcemeta::core::JSONL::Mode::GZIP
+                          : sourcemeta::core::JSONL::Mode::Raw}) {
+      if (batch.empty() || batch.back().size() == TRAFFIC_BLOCK_RECORDS) {
+        if (batch.size() == jobs) {
+          flush();
+        }
+
+        batch.emplace_back();
+        batch.back().reserve(TRAFFIC_BLOCK_RECORDS);
+      }
+
+      batch.back().push_back({.document = record, .index = count});
+      count += 1;
+    }
+  } catch (const sourcemeta::core::GZIPError &error) {
+    throw sourcemeta::core::FileError<sourcemeta::core::GZIPError>(
+        traffic_path, error.what());
+  } catch (const sourcemeta::core::JSONParseError &error) {
+    throw sourcemeta::core::JSONFileParseError(traffic_path, error);
+  }
+
+  flush();
+
+  if (count == 0) {
+    LOG_WARNING() << "The JSONL file is empty\n";
+  }
+
+  if (!result) {
+    throw Fail{EXIT_EXPECTED_FAILURE};
+  }
+}
@@ -18,6 +18,7 @@
 #include <chrono>    // std::chrono
 #include <cstddef>   // std::size_t
 #include <exception> // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <filesystem>  // std::filesystem
 #include <iostream>    // std::cout
 #include <mutex>       // std::mutex, std::lock_guard
 #include <optional>    // std::optional
@@ -25,6 +26,7 @@
 #include <string>      // std::string
 #include <string_view> // std::string_view
 #include <thread>      // std::this_thread
+#include <utility>     // std::move
 #include <vector>      // std::vector
 
 #include "command.h"
@@ -34,7 +36,10 @@
 #include "input.h"
 #include "logger.h"
 #include "resolver.h"
+#include "template_cache.h"
+#include "timings.h"
 #include "utils.h"
+#include "watch.h"
 
 namespace {
 
@@ -109,11 +114,41 @@ auto print_rdf_failure(const sourcemeta::jsonschema::InputJSON &entry,
   }
 }
 
+// In `--watch/-W` mode, we only run the test suites that the last changes
+// affected
+auto unaffected(const std::filesystem::path &path) -> bool {
+  return !sourcemeta::jsonschema::Watch::instance().affected(path);
+}
+
+// Test cases may read their instances from other files, which the resolver
+// never sees
+auto depend_on_data_paths(const sourcemeta::jsonschema::InputJSON &entry)
+    -> void {
+  if (entry.from_stdin || !entry.second.is_object() ||
+      !entry.second.defines("tests") || !entry.second.at("tests").is_array()) {
+    return;
+  }
+
+  for (const auto &test_case : entry.second.at("tests").as_array()) {
+    for (const auto *property : {"dataPath", "rdfPath"}) {
+      if (test_case.is_object() && test_case.defines(property) &&
+          test_case.at(property).is_string()) {
+        sourcemeta::jsonschema::WatchScope::depend(
+            entry.resolution_base.parent_path() /
+            test_case.at(property).to_string());
+      }
+    }
+  }
+}
+
 auto parse_test_suite(const sourcemeta::jsonschema::InputJSON &entry,
                       const sourcemeta::blaze::SchemaResolver &schema_resolver,
                       const std::string_view dialect,
-                      const std::optional<sourcemeta::blaze::Tweaks> &tweaks)
-    -> sourcemeta::blaze::TestSuite {
+                      const std::optional<sourcemeta::blaze::Tweaks> &tweaks,
+                      const sourcemeta::blaze::TestSuite::TemplateProvider
+                          &template_provider) -> sourcemeta::blaze::TestSuite {
+  const sourcemeta::jsonschema::TimingsScope timing{"compile",
+                                                    entry.resolution_base};
   try {
     return sourcemeta::blaze::TestSuite::parse(
         entry.second, entry.positions,
@@ -123,7 +158,8 @@ auto parse_test_suite(const sourcemeta::jsonschema::InputJSON &entry,
         entry.from_stdin ? std::filesystem::current_path()
                          : entry.resolution_base.parent_path(),
         schema_resolver, sourcemeta::blaze::schema_walker,
-        sourcemeta::blaze::default_schema_compiler, dialect, "", tweaks);
+        sourcemeta::blaze::default_schema_compiler, dialect, "", tweaks,
+        template_provider);
   } catch (const sourcemeta::blaze::TestParseError &error) {
     throw sourcemeta::core::FileError<sourcemeta::blaze::TestParseError>{
         entry.resolution_base, error.what(), error.location(), error.line(),
@@ -182,6 +218,26 @@ auto warm_caches(const sourcemeta::core::Options &options,
   }
 }
 
+// A suite with many test cases would pin a single thread while others sit
+// idle, so we run such suites one at a time after the rest, spreading their
+// test cases across every thread instead
+constexpr std::size_t LARGE_SUITE_TEST_CASES{1024};
+
+auto is_large_suite(const sourcemeta::jsonschema::InputJSON &entry,
+                    const std::size_t jobs) -> bool {
+  if (jobs <= 1 || !entry.second.is_object() ||
+      !entry.second.defines("tests") ||
+      !entry.second.at("tests").is_array()) {
+    return false;
+  }
+
+  const auto targets{entry.second.defines("target") &&
+                             entry.second.at("target").is_array()
+                         ? entry.second.at("target").size()
+                         : 1};
+  return targets * entry.second.at("tests").size() >= LARGE_SUITE_TEST_CASES;
+}
+
 auto emit_target_header(
     const bool multi_target, const sourcemeta::core::JSON::String &target,
     std::optional<sourcemeta::core::JSON::String> &last_target_header,
@@ -194,7 +250,9 @@ auto emit_target_header(
 
 auto run_suite_as_text(const sourcemeta::core::Options &options,
                        const sourcemeta::jsonschema::InputJSON &entry,
-                       const bool verbose, std::ostream &stream)
+                       const bool verbose,
+                       sourcemeta::jsonschema::TemplateCache &cache,
+                       const std::size_t concurrency, std::ostream &stream)
     -> sourcemeta::blaze::TestSuite::Result {
   const auto configuration_path{
       sourcemeta::jsonschema::find_configuration(entry.resolution_base)};
@@ -205,15 +263,20 @@ auto run_suite_as_text(const sourcemeta::core::Options &options,
   const auto &schema_resolver{sourcemeta::jsonschema::resolver(
       options, options.contains("http"), dialect, configuration)};
 
+  const sourcemeta::jsonschema::WatchScope watch_scope{entry.resolution_base};
+  depend_on_data_paths(entry);
   auto test_suite{parse_test_suite(
       entry, schema_resolver, dialect,
-      sourcemeta::jsonschema::format_assertion_tweaks(options))};
+      sourcemeta::jsonschema::format_assertion_tweaks(options),
+      cache.provider(schema_resolver))};
 
   stream << entry.first << ":";
 
   const auto multi_target{test_suite.targets.size() > 1};
   std::optional<sourcemeta::core::JSON::String> last_target_header;
 
+  const sourcemeta::jsonschema::TimingsScope timing{"test",
+                                                    entry.resolution_base};
   const auto suite_result{test_suite.run(
       [&](const sourcemeta::core::JSON::String &target, std::size_t index,
           std::size_t total, const sourcemeta::blaze::TestCase &test_case,
@@ -284,7 +347,8 @@ auto run_suite_as_text(const sourcemeta::core::Options &options,
             stream << "\n";
           }
         }
-      })};
+      },
+      concurrency)};
 
   if (suite_result.total == 0) {
     stream << " NO TESTS\n";
@@ -302,51 +366,66 @@ auto report_as_text(const sourcemeta::core::Options &options,
   bool empty_test_suite{false};
   const auto verbose{options.contains("verbose") || options.contains("debug")};
 
-  const auto entries{sourcemeta::jsonschema::for_each_json(options)};
+  const auto entries{sourcemeta::jsonschema::for_each_json(
+      options, unaffected, sourcemeta::jsonschema::parse_shard(options))};
   warm_caches(options, entries);
+  sourcemeta::jsonschema::TemplateCache cache;
 
   std::mutex output_mutex;
   std::atomic<bool> skip_remaining{false};
   std::exception_ptr first_error{nullptr};
   std::string first_error_path;
 
+  const auto run_entry{[&](const sourcemeta::jsonschema::InputJSON &entry,
+                            const std::size_t concurrency) {
+    if (skip_remaining.load()) {
+      return;
+    }
+
+    try {
+      // Buffer the output of every suite, so that we only need to hold
+      // the output lock while emitting it, letting suites actually
+      // evaluate their test cases in parallel
+      std::ostringstream buffer;
+      const auto suite_result{run_suite_as_text(options, entry, verbose, cache,
+                                                concurrency, buffer)};
+
+      const std::lock_guard<std::mutex> lock{output_mutex};
+      std::cout << buffer.str();
+
+      if (suite_result.passed != suite_result.total) {
+        result = false;
+      }
+
+      if (suite_result.total == 0) {
+        empty_test_suite = true;
+      }
+    } catch (...) {
+      const std::lock_guard<std::mutex> lock{output_mutex};
+      if (!first_error) {
+        first_error = std::current_exception();
+        first_error_path = entry.first;
+        skip_remaining.store(true);
+      }
+    }
+  }};
+
   sourcemeta::core::parallel_for_each(
       entries.cbegin(), entries.cend(),
       [&](const sourcemeta::jsonschema::InputJSON &entry, const std::size_t,
           const std::size_t) {
-        if (skip_remaining.load()) {
-          return;
-        }
-
-        try {
-          // Buffer the output of every suite, so that we only need to hold
-          // the output lock while emitting it, letting suites actually
-          // evaluate their test cases in parallel
-          std::ostringstream buffer;
-          const auto suite_result{
-              run_suite_as_text(options, entry, verbose, buffer)};
-
-          const std::lock_guard<std::mutex> lock{output_mutex};
-          std::cout << buffer.str();
-
-          if (suite_result.passed != suite_result.total) {
-            result = false;
-          }
-
-          if (suite_result.total == 0) {
-            empty_test_suite = true;
-          }
-        } catch (...) {
-          const std::lock_guard<std::mutex> lock{output_mutex};
-          if (!first_error) {
-            first_error = std::current_exception();
-            first_error_path = entry.first;
-            skip_remaining.store(true);
-          }
+        if (!is_large_suite(entry, jobs)) {
+          run_entry(entry, 1);
         }
       },
       jobs);
 
+  for (const auto &entry : entries) {
+    if (is_large_suite(entry, jobs)) {
+      run_entry(entry, jobs);
+    }
+  }
+
   if (first_error) {
     std::cout << first_error_path << ":\n";
     std::rethrow_exception(first_error);
@@ -392,7 +471,9 @@ struct CtrfSuiteReport {
 
 auto run_suite_as_ctrf(const sourcemeta::core::Options &options,
                        const sourcemeta::jsonschema::InputJSON &entry,
-                       CtrfSuiteReport &report) -> void {
+                       sourcemeta::jsonschema::TemplateCache &cache,
+                       const std::size_t concurrency, CtrfSuiteReport &report)
+    -> void {
   const auto configuration_path{
       sourcemeta::jsonschema::find_configuration(entry.resolution_base)};
   const auto &configuration{
@@ -402,12 +483,17 @@ auto run_suite_as_ctrf(const sourcemeta::core::Options &options,
   const auto &schema_resolver{sourcemeta::jsonschema::resolver(
       options, options.contains("http"), dialect, configuration)};
 
+  const sourcemeta::jsonschema::WatchScope watch_scope{entry.resolution_base};
+  depend_on_data_paths(entry);
   auto test_suite{parse_test_suite(
       entry, schema_resolver, dialect,
-      sourcemeta::jsonschema::format_assertion_tweaks(options))};
+      sourcemeta::jsonschema::format_assertion_tweaks(options),
+      cache.provider(schema_resolver))};
 
   const auto file_path{entry.first};
 
+  const sourcemeta::jsonschema::TimingsScope timing{"test",
+                                                    entry.resolution_base};
   const auto suite_result{test_suite.run(
       [&](const sourcemeta::core::JSON::String &target, std::size_t index,
           std::size_t, const sourcemeta::blaze::TestCase &test_case,
@@ -473,7 +559,8 @@ auto run_suite_as_ctrf(const sourcemeta::core::Options &options,
         }
 
         report.tests.push_back(std::move(test_object));
-      })};
+      },
+      concurrency)};
 
   report.passed = suite_result.passed;
   report.total = suite_result.total;
@@ -489,36 +576,52 @@ auto report_as_ctrf(const sourcemeta::core::Options &options,
   const auto system_ref{std::chrono::system_clock::now()};
   const auto steady_ref{std::chrono::steady_clock::now()};
 
-  const auto entries{sourcemeta::jsonschema::for_each_json(options)};
+  const auto shard{sourcemeta::jsonschema::parse_shard(options)};
+  const auto entries{
+      sourcemeta::jsonschema::for_each_json(options, unaffected, shard)};
   warm_caches(options, entries);
+  sourcemeta::jsonschema::TemplateCache cache;
 
   std::vector<CtrfSuiteReport> reports{entries.size()};
   std::mutex error_mutex;
   std::atomic<bool> skip_remaining{false};
   std::exception_ptr first_error{nullptr};
 
+  const auto run_entry{[&](const sourcemeta::jsonschema::InputJSON &entry,
+                            const std::size_t concurrency) {
+    if (skip_remaining.load()) {
+      return;
+    }
+
+    try {
+      run_suite_as_ctrf(
+          options, entry, cache, concurrency,
+          reports[static_cast<std::size_t>(&entry - entries.data())]);
+    } catch (...) {
+      const std::lock_guard<std::mutex> lock{error_mutex};
+      if (!first_error) {
+        first_error = std::current_exception();
+        skip_remaining.store(true);
+      }
+    }
+  }};
+
   sourcemeta::core::parallel_for_each(
       entries.cbegin(), entries.cend(),
       [&](const sourcemeta::jsonschema::InputJSON &entry, const std::size_t,
           const std::size_t) {
-        if (skip_remaining.load()) {
-          return;
-        }
-
-        try {
-          run_suite_as_ctrf(
-              options, entry,
-              reports[static_cast<std::size_t>(&entry - entries.data())]);
-        } catch (...) {
-          const std::lock_guard<std::mutex> lock{error_mutex};
-          if (!first_error) {
-            first_error = std::current_exception();
-            skip_remaining.store(true);
-          }
+        if (!is_large_suite(entry, jobs)) {
+          run_entry(entry, 1);
         }
       },
       jobs);
 
+  for (const auto &entry : entries) {
+    if (is_large_suite(entry, jobs)) {
+      run_entry(entry, jobs);
+    }
+  }
+
   if (first_error) {
     std::rethrow_exception(first_error);
   }
@@ -584,6 +687,20 @@ auto report_as_ctrf(const sourcemeta::core::Options &options,
   results.assign("summary", std::move(summary));
   results.assign("tests", std::move(ctrf_tests));
 
+  // Tell the reports of every shard apart, so that they can be merged
+  if (shard.has_value()) {
+    auto shard_object{sourcemeta::core::JSON::make_object()};
+    shard_object.assign("index",
+                        sourcemeta::core::JSON{
+                            static_cast<std::int64_t>(shard.value().index)});
+    shard_object.assign("count",
+                        sourcemeta::core::JSON{
+                            static_cast<std::int64_t>(shard.value().count)});
+    auto extra{sourcemeta::core::JSON::make_object()};
+    extra.assign("shard", std::move(shard_object));
+    results.assign("extra", std::move(extra));
+  }
+
   auto ctrf{sourcemeta::core::JSON::make_object()};
   ctrf.assign("reportFormat", sourcemeta::core::JSON{"CTRF"});
   ctrf.assign("specVersion", sourcemeta::core::JSON{"0.0.0"});
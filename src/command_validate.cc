@@ -9,19 +9,31 @@
 #include <sourcemeta/blaze/evaluator.h>
 #include <sourcemeta/blaze/output.h>
 
-#include <chrono>      // std::chrono
-#include <cmath>       // std::sqrt
+#include <algorithm>   // std::ranges::lower_bound, std::max
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint64_t
+#include <fstream>     // std::ifstream
 #include <iostream>    // std::cerr
+#include <memory>      // std::unique_ptr, std::make_unique
+#include <optional>    // std::optional, std::nullopt
 #include <string>      // std::string
 #include <string_view> // std::string_view
+#include <tuple>       // std::get
+#include <utility>     // std::move, std::as_const
+#include <variant>     // std::get_if
+#include <vector>      // std::vector
 
+#include "benchmark.h"
 #include "command.h"
 #include "configuration.h"
 #include "error.h"
 #include "input.h"
 #include "logger.h"
+#include "records.h"
 #include "resolver.h"
+#include "timings.h"
 #include "utils.h"
+#include "watch.h"
 
 namespace {
 
@@ -80,69 +92,63 @@ auto parse_loop(const sourcemeta::core::Options &options) -> std::uint64_t {
   }
 }
 
-// validate instance in a loop to measure avg and stdev
-auto run_loop(sourcemeta::blaze::Evaluator &evaluator,
-              const sourcemeta::blaze::Template &schema_template,
-              const sourcemeta::core::JSON &instance,
-              const std::string &instance_path, const int64_t instance_index,
-              const uint64_t loop) -> bool {
-  const auto iterations = static_cast<double>(loop);
-  double sum = 0.0, sum2 = 0.0, empty = 0.0;
-  bool result = true;
-
-  // Overhead evaluation, if not to optimize out!
-  for (auto index = loop; index; index--) {
-    const auto start{std::chrono::high_resolution_clock::now()};
-    const auto end{std::chrono::high_resolution_clock::now()};
-    empty +=
-        static_cast<double>(
-            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
-                .count()) /
-        1000.0;
-  }
-  empty /= iterations;
-
-  // Actual performance loop
-  for (auto index = loop; index; index--) {
-    const auto start{std::chrono::high_resolution_clock::now()};
-    result = evaluator.validate(schema_template, instance);
-    const auto end{std::chrono::high_resolution_clock::now()};
-
-    const auto raw_delay =
-        static_cast<double>(
-            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
-                .count()) /
-        1000.0;
-    const auto delay = std::max(0.0, raw_delay - empty);
-    sum += delay;
-    sum2 += delay * delay;
-  }
-
-  // Display json source, result and performance
-  auto avg = sum / iterations;
-  auto stdev = loop == 1 ? 0.0 : std::sqrt(sum2 / iterations - avg * avg);
-
-  std::cout << instance_path;
-  if (instance_index >= 0)
-    std::cout << "[" << instance_index << "]";
-  std::cout << std::fixed;
-  std::cout.precision(3);
-  std::cout << ": " << (result ? "PASS" : "FAIL") << " " << avg << " +- "
-            << stdev << " us (" << empty << ")\n";
+auto parse_warmup(const sourcemeta::core::Options &options,
+                  const std::uint64_t loop) -> std::uint64_t {
+  if (options.contains("warmup")) {
+    return std::stoull(options.at("warmup").front().data());
+  } else {
+    // Warm up for a tenth of the measured iterations by default
+    return loop / 10;
+  }
+}
 
-  return result;
+struct BenchmarkSession {
+  std::uint64_t loop;
+  std::uint64_t warmup;
+  bool json_output;
+  std::unique_ptr<sourcemeta::jsonschema::HardwareCounters> counters;
+  std::vector<sourcemeta::jsonschema::BenchmarkResult> results;
+};
+
+auto record_benchmark(BenchmarkSession &session,
+                      sourcemeta::blaze::Evaluator &evaluator,
+                      const sourcemeta::blaze::Template &schema_template,
+                      const sourcemeta::core::JSON &instance, std::string path,
+                      const std::optional<std::size_t> index) -> bool {
+  const auto &result{
+      session.results.emplace_back(sourcemeta::jsonschema::run_benchmark(
+          evaluator, schema_template, instance, std::move(path), index,
+          session.loop, session.warmup, session.counters.get()))};
+  if (!session.json_output) {
+    sourcemeta::jsonschema::print(result, std::cout);
+  }
+
+  return result.valid;
 }
 
+// The schema to validate against. In `--watch/-W` mode, it remains resident
+// across runs until the schema or anything it depends on changes
+struct EvaluationSchema {
+  sourcemeta::core::JSON bundled{nullptr};
+  sourcemeta::blaze::SchemaFrame frame{
+      sourcemeta::blaze::SchemaFrame::Mode::References};
+  std::string entrypoint_uri;
+  sourcemeta::blaze::Template schema_template{};
+};
+
 // Returns false if iteration should stop
 auto process_entry(
     const sourcemeta::jsonschema::InputJSON &entry,
     sourcemeta::blaze::Evaluator &evaluator,
     const sourcemeta::blaze::Template &schema_template,
     const sourcemeta::jsonschema::CustomResolver &custom_resolver,
-    const sourcemeta::blaze::SchemaFrame &frame, bool benchmark,
-    std::uint64_t benchmark_loop, bool trace, bool fast_mode, bool json_output,
-    bool continue_on_error, const std::filesystem::path &schema_resolution_base,
+    const sourcemeta::blaze::SchemaFrame &frame, BenchmarkSession *benchmark,
+    sourcemeta::jsonschema::RecordWriter *records, bool trace, bool fast_mode,
+    bool json_output, bool continue_on_error,
+    const std::filesystem::path &schema_resolution_base,
     const sourcemeta::core::Options &options, bool &result) -> bool {
+  const sourcemeta::jsonschema::TimingsScope timing{"evaluate",
+                                                    entry.resolution_base};
   sourcemeta::blaze::SimpleOutput output{entry.second};
   sourcemeta::blaze::TraceOutput trace_output{
       sourcemeta::blaze::schema_walker, custom_resolver,
@@ -150,11 +156,10 @@ auto process_entry(
       sourcemeta::core::EMPTY_WEAK_POINTER, frame};
   bool subresult{true};
   if (benchmark) {
-    subresult = run_loop(evaluator, schema_template, entry.second, entry.first,
-                         entry.multidocument
-                             ? static_cast<std::int64_t>(entry.index + 1)
-                             : static_cast<std::int64_t>(-1),
-                         benchmark_loop);
+    subresult = record_benchmark(
+        *benchmark, evaluator, schema_template, entry.second, entry.first,
+        entry.multidocument ? std::optional<std::size_t>{entry.index + 1}
+                            : std::nullopt);
     if (!subresult) {
       result = false;
     }
@@ -173,7 +178,7 @@ auto process_entry(
   } else if (trace) {
     result = result && subresult;
   } else if (json_output) {
-    if (!entry.multidocument) {
+    if (!entry.multidocument && records == nullptr) {
       std::cerr << entry.first << "\n";
     }
     const auto suboutput{sourcemeta::blaze::standard(
@@ -184,8 +189,16 @@ auto process_entry(
     assert(suboutput.is_object());
     assert(suboutput.defines("valid"));
     assert(suboutput.at("valid").is_boolean());
-    sourcemeta::core::prettify(suboutput, std::cout);
-    std::cout << "\n";
+    if (records != nullptr) {
+      records->write(entry.first,
+                     entry.multidocument
+                         ? std::optional<std::size_t>{entry.index + 1}
+                         : std::nullopt,
+                     suboutput);
+    } else {
+      sourcemeta::core::prettify(suboutput, std::cout);
+      std::cout << "\n";
+    }
     if (!suboutput.at("valid").to_boolean()) {
       result = false;
       if (entry.multidocument && !continue_on_error) {
@@ -229,6 +242,190 @@ auto process_entry(
   return true;
 }
 
+// The projection node that a property of an object at the given node leads to
+auto projection_property(const sourcemeta::core::JSONProjection::Node &node,
+                         const sourcemeta::core::JSON::String &name)
+    -> std::optional<std::size_t> {
+  const auto match{std::ranges::lower_bound(
+      node.properties, name, {},
+      [](const auto &property) -> const auto & { return property.first; })};
+  return match != node.properties.cend() && match->first == name
+             ? std::optional<std::size_t>{match->second}
+             : node.other;
+}
+
+// Null out whatever the projection does not reach, as if the value was parsed
+// with the projection in the first place
+auto project_value(sourcemeta::core::JSON &value,
+                   const sourcemeta::core::JSONProjection &projection,
+                   const std::optional<std::size_t> &node) -> void {
+  if (!node.has_value()) {
+    value = sourcemeta::core::JSON{nullptr};
+    return;
+  }
+
+  const auto &entry{projection.nodes[node.value()]};
+  if (entry.all) {
+    return;
+  } else if (value.is_array()) {
+    for (auto &item : value.as_array()) {
+      project_value(item, projection, entry.items);
+    }
+  } else if (value.is_object()) {
+    // Projecting a property never changes the names of the object
+    for (const auto &property : std::as_const(value).as_object()) {
+      project_value(value.at(property.first), projection,
+                    projection_property(entry, property.first));
+    }
+  }
+}
+
+// The largest size that the given instructions compare an instance against.
+// Arrays with more items than that all evaluate the same way, as long as the
+// instructions only look at the size of the array and not at its items
+auto size_bound(const sourcemeta::blaze::Instructions &instructions)
+    -> std::size_t {
+  std::size_t result{0};
+  const auto range_bound{[&result](const sourcemeta::blaze::ValueRange &range) {
+    result = std::max(result, std::get<0>(range));
+    if (std::get<1>(range).has_value()) {
+      result = std::max(result, std::get<1>(range).value());
+    }
+  }};
+
+  for (const auto &instruction : instructions) {
+    if (const auto *value{
+            std::get_if<sourcemeta::blaze::ValueUnsignedInteger>(
+                &instruction.value)}) {
+      result = std::max(result, *value);
+    } else if (const auto *range{std::get_if<sourcemeta::blaze::ValueRange>(
+                   &instruction.value)}) {
+      range_bound(*range);
+    } else if (const auto *bounds{
+                   std::get_if<sourcemeta::blaze::ValueIntegerBoundsWithSize>(
+                       &instruction.value)}) {
+      range_bound(bounds->second);
+    }
+
+    result = std::max(result, size_bound(instruction.children));
+  }
+
+  return result;
+}
+
+// Validate a top-level array or object one entry at a time, only keeping
+// around what the rest of the schema needs to see of each entry
+auto validate_stream(sourcemeta::blaze::Evaluator &evaluator,
+                     const sourcemeta::blaze::Template &schema_template,
+                     const std::filesystem::path &path) -> bool {
+  std::ifstream stream{sourcemeta::core::canonical(path), std::ios::binary};
+  stream.exceptions(std::ifstream::badbit);
+  try {
+    sourcemeta::core::JSONEntryStream entries{stream};
+    const auto type{entries.type()};
+    const auto split{sourcemeta::blaze::stream(schema_template, type)};
+    const auto is_array{type == sourcemeta::core::JSON::Type::Array};
+    auto document{is_array ? sourcemeta::core::JSON::make_array()
+                           : sourcemeta::core::JSON::make_object()};
+
+    // Otherwise, we have no choice but to validate the document as a whole
+    if (!split.has_value()) {
+      if (type != sourcemeta::core::JSON::Type::Array &&
+          type != sourcemeta::core::JSON::Type::Object) {
+        document = entries.next();
+      }
+
+      while (!entries.done()) {
+        auto value{entries.next()};
+        if (document.is_array()) {
+          document.push_back(std::move(value));
+        } else {
+          document.assign(entries.name(), std::move(value));
+        }
+      }
+
+      return evaluator.validate(schema_template, document);
+    }
+
+    // What the rest of the schema needs to see of the entries, so that we
+    // never hold on to more than that
+    enum class Collect : std::uint8_t { Nothing, Count, Names, Projection };
+    const auto &root{split->projection.nodes.front()};
+    auto collect{Collect::Projection};
+    if (split->rest.targets.front().empty()) {
+      collect = Collect::Nothing;
+    } else if (root.all) {
+      collect = Collect::Projection;
+    } else if (is_array && !root.items.has_value()) {
+      collect = Collect::Count;
+    } else if (!is_array && root.properties.empty() &&
+               !root.other.has_value()) {
+      collect = Collect::Names;
+    }
+
+    std::size_t count{0};
+    while (!entries.done()) {
+      auto value{entries.next()};
+      auto wrapper{is_array ? sourcemeta::core::JSON::make_array()
+                            : sourcemeta::core::JSON::make_object()};
+      if (is_array) {
+        wrapper.push_back(std::move(value));
+      } else {
+        wrapper.assign(entries.name(), std::move(value));
+      }
+
+      if (!evaluator.validate(split->entry, wrapper)) {
+        return false;
+      }
+
+      switch (collect) {
+        case Collect::Nothing:
+          break;
+        case Collect::Count:
+          count += 1;
+          break;
+        case Collect::Names:
+          document.assign(entries.name(), sourcemeta::core::JSON{nullptr});
+          break;
+        case Collect::Projection:
+          if (is_array) {
+            value = std::move(wrapper.at(0));
+            project_value(value, split->projection, root.items);
+            document.push_back(std::move(value));
+          } else {
+            const auto &name{entries.name()};
+            value = std::move(wrapper.at(name));
+            project_value(value, split->projection,
+                          projection_property(root, name));
+            document.assign(name, std::move(value));
+          }
+
+          break;
+      }
+    }
+
+    if (collect == Collect::Nothing) {
+      return true;
+    } else if (collect == Collect::Count) {
+      // Only the size of the array matters, so any size past what the rest
+      // of the schema compares against gives the same result
+      std::size_t bound{0};
+      for (const auto &target : split->rest.targets) {
+        bound = std::max(bound, size_bound(target));
+      }
+
+      const auto size{bound < count ? bound + 1 : count};
+      for (std::size_t index = 0; index < size; index++) {
+        document.push_back(sourcemeta::core::JSON{nullptr});
+      }
+    }
+
+    return evaluator.validate(split->rest, document);
+  } catch (const sourcemeta::core::JSONParseError &error) {
+    throw sourcemeta::core::JSONFileParseError(path, error);
+  }
+}
+
 } // namespace
 
 auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
@@ -247,6 +444,7 @@ auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
 
   // Centralized duplicate stdin check for all positional arguments
   check_no_duplicate_stdin(options.positional());
+  const auto shard{parse_shard(options)};
 
   if (!schema_from_stdin && std::filesystem::is_directory(schema_path)) {
     throw sourcemeta::core::IOIsADirectoryError{schema_path};
@@ -263,20 +461,31 @@ auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
       read_configuration(options, configuration_path, schema_config_base)};
   const auto dialect{default_dialect(options, configuration)};
 
-  auto parsed_schema{schema_from_stdin ? read_from_stdin()
-                                       : read_file(schema_path)};
-
-  if (!sourcemeta::blaze::is_schema(parsed_schema.document)) {
-    throw NotSchemaError{schema_from_stdin ? stdin_path()
-                                           : schema_resolution_base};
+  static std::unique_ptr<EvaluationSchema> resident;
+  const auto &watch{Watch::instance()};
+  const auto reuse{resident != nullptr &&
+                   !watch.affected(schema_resolution_base)};
+  if (reuse) {
+    LOG_VERBOSE(options) << "Reusing the compiled schema: "
+                         << stdin_path_string(schema_resolution_base) << "\n";
   }
 
-  const auto &schema{parsed_schema.document};
+  std::optional<ParsedJSON> parsed_schema;
+  if (!reuse) {
+    parsed_schema = schema_from_stdin ? read_from_stdin()
+                                      : read_file(schema_path);
+    if (!sourcemeta::blaze::is_schema(parsed_schema->document)) {
+      throw NotSchemaError{schema_from_stdin ? stdin_path()
+                                             : schema_resolution_base};
+    }
+  }
 
   const auto &custom_resolver{
       resolver(options, options.contains("http"), dialect, configuration)};
 
-  const auto fast_mode{options.contains("fast")};
+  // Streaming only tells whether the instance is valid, as in fast mode
+  const auto stream{options.contains("stream")};
+  const auto fast_mode{options.contains("fast") || stream};
   const auto benchmark{options.contains("benchmark")};
   const auto benchmark_loop{parse_loop(options)};
   if (benchmark_loop == 0) {
@@ -284,7 +493,54 @@ auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
   }
 
   const auto trace{options.contains("trace")};
-  const auto json_output{options.contains("json")};
+  // NDJSON is a more compact form of JSON output
+  const auto ndjson{options.contains("ndjson")};
+  const auto json_output{options.contains("json") || ndjson};
+
+  if (ndjson && (benchmark || trace)) {
+    throw OptionConflictError{"The `--ndjson` option cannot be used with "
+                              "`--benchmark/-b` or `--trace/-t`"};
+  }
+
+  if (stream && (benchmark || trace)) {
+    throw OptionConflictError{"The `--stream` option cannot be used with "
+                              "`--benchmark/-b` or `--trace/-t`"};
+  }
+
+  if (!benchmark &&
+      (options.contains("warmup") || options.contains("counters"))) {
+    throw OptionConflictError{"The `--warmup` and `--counters` options "
+                              "require `--benchmark/-b`"};
+  }
+
+  std::optional<BenchmarkSession> benchmark_session;
+  if (benchmark) {
+    benchmark_session.emplace(
+        BenchmarkSession{.loop = benchmark_loop,
+                         .warmup = parse_warmup(options, benchmark_loop),
+                         .json_output = json_output,
+                         .counters = nullptr,
+                         .results = {}});
+    if (options.contains("counters")) {
+      benchmark_session->counters = std::make_unique<HardwareCounters>();
+      if (!benchmark_session->counters->available()) {
+        LOG_WARNING() << "Hardware performance counters are not available on "
+                         "this system\n";
+        benchmark_session->counters.reset();
+      }
+    }
+  }
+
+  auto *const benchmark_pointer{benchmark_session.has_value()
+                                    ? &benchmark_session.value()
+                                    : nullptr};
+  std::optional<RecordWriter> records;
+  if (ndjson) {
+    records.emplace(std::cout);
+  }
+
+  auto *const records_pointer{records.has_value() ? &records.value()
+                                                  : nullptr};
   const auto continue_on_error{options.contains("continue")};
 
   if (options.contains("entrypoint") && !options.at("entrypoint").empty() &&
@@ -300,36 +556,57 @@ auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
         "Re-compile the template with --format-assertion instead"};
   }
 
-  const auto schema_default_id{sourcemeta::jsonschema::default_id(
-      schema_resolution_base, schema_from_stdin)};
-
-  const auto bundled{
-      bundle_for_evaluation(schema, custom_resolver, dialect, schema_default_id,
-                            schema_resolution_base, parsed_schema.positions)};
-
-  sourcemeta::blaze::SchemaFrame frame{
-      sourcemeta::blaze::SchemaFrame::Mode::References};
-  frame_for_evaluation(frame, bundled, custom_resolver, dialect,
-                       schema_default_id, schema_resolution_base,
-                       parsed_schema.positions);
-
-  std::string entrypoint_uri{frame.root()};
-  if (options.contains("entrypoint") && !options.at("entrypoint").empty()) {
-    try {
-      entrypoint_uri =
-          resolve_entrypoint(frame, options.at("entrypoint").front());
-    } catch (const sourcemeta::blaze::CompilerInvalidEntryPoint &error) {
-      throw sourcemeta::core::FileError<
-          sourcemeta::blaze::CompilerInvalidEntryPoint>(schema_resolution_base,
-                                                        error);
+  if (!reuse) {
+    // Only replace the resident schema once it fully compiled, so that a
+    // failed attempt does not leave a broken one behind
+    auto compiled{std::make_unique<EvaluationSchema>()};
+    const WatchScope watch_scope{schema_resolution_base};
+    const auto schema_default_id{sourcemeta::jsonschema::default_id(
+        schema_resolution_base, schema_from_stdin)};
+
+    compiled->bundled = bundle_for_evaluation(
+        parsed_schema->document, custom_resolver, dialect, schema_default_id,
+        schema_resolution_base, parsed_schema->positions);
+
+    frame_for_evaluation(compiled->frame, compiled->bundled, custom_resolver,
+                         dialect, schema_default_id, schema_resolution_base,
+                         parsed_schema->positions);
+
+    compiled->entrypoint_uri = compiled->frame.root();
+    if (options.contains("entrypoint") && !options.at("entrypoint").empty()) {
+      try {
+        compiled->entrypoint_uri = resolve_entrypoint(
+            compiled->frame, options.at("entrypoint").front());
+      } catch (const sourcemeta::blaze::CompilerInvalidEntryPoint &error) {
+        throw sourcemeta::core::FileError<
+            sourcemeta::blaze::CompilerInvalidEntryPoint>(
+            schema_resolution_base, error);
+      }
     }
+
+    compiled->schema_template = get_schema_template(
+        compiled->bundled, custom_resolver, compiled->frame,
+        compiled->entrypoint_uri, fast_mode, options, schema_resolution_base,
+        parsed_schema->positions);
+    resident = std::move(compiled);
   }
 
-  const auto schema_template{get_schema_template(
-      bundled, custom_resolver, frame, entrypoint_uri, fast_mode, options,
-      schema_resolution_base, parsed_schema.positions)};
+  const auto &frame{resident->frame};
+  const auto &schema_template{resident->schema_template};
+  // Unless the schema changed, we only need to validate the instances that
+  // changed since the previous run
+  InputSkip skip;
+  if (reuse) {
+    skip = [&watch](const std::filesystem::path &path) {
+      return !watch.affected(path);
+    };
+  }
 
   sourcemeta::blaze::Evaluator evaluator;
+  // In fast mode, nothing reports on the instance beyond whether it is valid,
+  // so we can skip materialising the parts that the schema never looks at
+  const auto projection{fast_mode ? sourcemeta::blaze::project(schema_template)
+                                  : std::nullopt};
 
   bool result{true};
 
@@ -349,10 +626,14 @@ auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
         "The `--trace/-t` option is only allowed given a single instance"};
   }
 
-  if (benchmark && instance_arguments.size() > 1) {
-    throw OptionConflictError{
-        "The `--benchmark/-b` option is only allowed given a single instance"};
-  }
+  // Validate every instance as soon as it is parsed, so that inputs with a
+  // large number of documents don't need to fit in memory at once
+  const InputVisitor visitor{[&](InputJSON &&entry) {
+    return process_entry(entry, evaluator, schema_template, custom_resolver,
+                         frame, benchmark_pointer, records_pointer, trace,
+                         fast_mode, json_output, continue_on_error,
+                         schema_resolution_base, options, result);
+  }};
 
   if (instance_arguments.empty()) {
     if (trace) {
@@ -360,19 +641,7 @@ auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
           "The `--trace/-t` option is only allowed given a single instance"};
     }
 
-    if (benchmark) {
-      throw OptionConflictError{"The `--benchmark/-b` option is only allowed "
-                                "given a single instance"};
-    }
-
-    for (const auto &entry : for_each_json({}, options)) {
-      if (!process_entry(entry, evaluator, schema_template, custom_resolver,
-                         frame, benchmark, benchmark_loop, trace, fast_mode,
-                         json_output, continue_on_error, schema_resolution_base,
-                         options, result)) {
-        break;
-      }
-    }
+    for_each_json({}, options, skip, shard, visitor);
   } else {
     for (const auto &instance_path_view : instance_arguments) {
       const std::filesystem::path instance_path{instance_path_view};
@@ -388,31 +657,54 @@ auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
             "The `--trace/-t` option is only allowed given a single instance"};
       }
 
-      if (benchmark && instance_path_view != "-" &&
-          std::filesystem::is_directory(instance_path)) {
-        throw OptionConflictError{"The `--benchmark/-b` option is only allowed "
-                                  "given a single instance"};
-      }
-
       if (instance_path_view == "-" ||
           std::filesystem::is_directory(instance_path) ||
           instance_path.extension() == ".jsonl" ||
           instance_path.string().ends_with(".jsonl.gz") ||
           instance_path.extension() == ".yaml" ||
           instance_path.extension() == ".yml") {
-        for (const auto &entry : for_each_json({instance_path_view}, options)) {
-          if (!process_entry(entry, evaluator, schema_template, custom_resolver,
-                             frame, benchmark, benchmark_loop, trace, fast_mode,
-                             json_output, continue_on_error,
-                             schema_resolution_base, options, result)) {
-            break;
+        for_each_json({instance_path_view}, options, skip, shard, visitor);
+      } else if ((!shard.has_value() ||
+                  shard.value().owns_argument(
+                      sourcemeta::core::weakly_canonical(instance_path))) &&
+                 (!skip || !skip(instance_path))) {
+        if (stream && instance_path.extension() == ".json") {
+          const auto canonical{
+              sourcemeta::core::weakly_canonical(instance_path)
+                  .generic_string()};
+          const TimingsScope timing{"evaluate", instance_path};
+          const auto subresult{
+              validate_stream(evaluator, schema_template, instance_path)};
+          if (!subresult) {
+            result = false;
           }
+
+          if (json_output) {
+            auto suboutput{sourcemeta::core::JSON::make_object()};
+            suboutput.assign("valid", sourcemeta::core::JSON{subresult});
+            if (records.has_value()) {
+              records->write(canonical, std::nullopt, suboutput);
+            } else {
+              sourcemeta::core::prettify(suboutput, std::cout);
+              std::cout << "\n";
+            }
+          } else if (subresult) {
+            LOG_VERBOSE(options)
+                << "ok: " << canonical << "\n  matches "
+                << stdin_path_string(schema_resolution_base) << "\n";
+          } else {
+            std::cerr << "fail: " << canonical
+                      << "\nerror: Schema validation failure\n";
+          }
+
+          continue;
         }
-      } else {
+
         sourcemeta::core::PointerPositionTracker tracker;
         auto property_storage = std::make_shared<std::deque<std::string>>();
         const bool track_positions{(!fast_mode && !benchmark) || trace};
         const auto instance{[&]() -> sourcemeta::core::JSON {
+          const TimingsScope parse_timing{"parse", instance_path};
           if (track_positions) {
             sourcemeta::core::JSON document{sourcemeta::core::JSON{nullptr}};
             auto callback = make_position_callback(tracker, property_storage);
@@ -420,8 +712,14 @@ auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
                                                 callback);
             return document;
           }
+          if (projection.has_value() && instance_path.extension() == ".json") {
+            return sourcemeta::core::read_json(instance_path,
+                                               projection.value());
+          }
+
           return sourcemeta::core::read_yaml_or_json(instance_path);
         }()};
+        const TimingsScope timing{"evaluate", instance_path};
         sourcemeta::blaze::SimpleOutput output{instance};
         sourcemeta::blaze::TraceOutput trace_output{
             sourcemeta::blaze::schema_walker, custom_resolver,
@@ -429,9 +727,10 @@ auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
             sourcemeta::core::EMPTY_WEAK_POINTER, frame};
         bool subresult{true};
         if (benchmark) {
-          subresult = run_loop(evaluator, schema_template, instance,
-                               instance_path.generic_string(), (int64_t)-1,
-                               benchmark_loop);
+          subresult = record_benchmark(benchmark_session.value(), evaluator,
+                                       schema_template, instance,
+                                       instance_path.generic_string(),
+                                       std::nullopt);
           if (!subresult) {
             result = false;
           }
@@ -447,6 +746,8 @@ auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
 
         if (trace) {
           result = result && subresult;
+        } else if (benchmark && json_output) {
+          continue;
         } else if (json_output) {
           const auto suboutput{sourcemeta::blaze::standard(
               evaluator, schema_template, instance,
@@ -460,8 +761,15 @@ auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
             result = false;
           }
 
-          sourcemeta::core::prettify(suboutput, std::cout);
-          std::cout << "\n";
+          if (records.has_value()) {
+            records->write(
+                sourcemeta::core::weakly_canonical(instance_path)
+                    .generic_string(),
+                std::nullopt, suboutput);
+          } else {
+            sourcemeta::core::prettify(suboutput, std::cout);
+            std::cout << "\n";
+          }
         } else if (subresult) {
           LOG_VERBOSE(options)
               << "ok: "
@@ -482,6 +790,20 @@ auto sourcemeta::jsonschema::validate(const sourcemeta::core::Options &options)
     }
   }
 
+  if (benchmark_session.has_value()) {
+    if (json_output) {
+      sourcemeta::core::prettify(to_json(benchmark_session->results),
+                                 std::cout);
+      std::cout << "\n";
+    } else if (benchmark_session->results.size() > 1) {
+      print_summary(benchmark_session->results, std::cout);
+    }
+  }
+
+  if (records.has_value()) {
+    records->flush();
+  }
+
   if (!result) {
     throw Fail{EXIT_EXPECTED_FAILURE};
   }
@@ -10,6 +10,8 @@
 
 #include "error.h"
 #include "logger.h"
+#include "timings.h"
+#include "watch.h"
 
 #include <cassert>    // assert
 #include <cstddef>    // std::size_t
@@ -28,21 +30,33 @@ inline auto find_configuration(const std::filesystem::path &path)
   return sourcemeta::blaze::Configuration::find(path);
 }
 
+using ConfigurationCache =
+    std::map<std::optional<std::filesystem::path>,
+             std::optional<sourcemeta::blaze::Configuration>>;
+
+inline auto configuration_cache() -> ConfigurationCache & {
+  static ConfigurationCache cache;
+  return cache;
+}
+
+// Forget every configuration file read so far, for `--watch/-W` to pick up
+// changes to them. This invalidates references to cached configurations
+inline auto reset_configurations() -> void { configuration_cache().clear(); }
+
 inline auto load_configuration(
     const sourcemeta::core::Options &options,
     const std::optional<std::filesystem::path> &configuration_path)
     -> const std::optional<sourcemeta::blaze::Configuration> & {
-  using CacheKey = std::optional<std::filesystem::path>;
-  static std::map<CacheKey, std::optional<sourcemeta::blaze::Configuration>>
-      configuration_cache;
-
-  auto iterator{configuration_cache.find(configuration_path)};
-  if (iterator != configuration_cache.end()) {
+  auto &cache{configuration_cache()};
+  auto iterator{cache.find(configuration_path)};
+  if (iterator != cache.end()) {
     return iterator->second;
   }
 
   std::optional<sourcemeta::blaze::Configuration> result{std::nullopt};
   if (configuration_path.has_value()) {
+    const TimingsScope timing{"configuration", configuration_path.value()};
+    Watch::instance().depend_globally(configuration_path.value());
     LOG_DEBUG(options) << "Using configuration file: "
                        << sourcemeta::core::weakly_canonical(
                               configuration_path.value())
@@ -117,7 +131,7 @@ inline auto load_configuration(
   }
 
   auto [inserted_iterator, inserted] =
-      configuration_cache.emplace(configuration_path, std::move(result));
+      cache.emplace(configuration_path, std::move(result));
   return inserted_iterator->second;
 }
 
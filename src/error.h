@@ -150,6 +150,33 @@ public:
       : std::runtime_error{"The --jobs option must be a positive integer"} {}
 };
 
+class InvalidShardError : public std::runtime_error {
+public:
+  InvalidShardError()
+      : std::runtime_error{"The --shard option must be of the form "
+                           "INDEX/COUNT, where 1 <= INDEX <= COUNT"} {}
+};
+
+class InvalidRecordRangeError : public std::runtime_error {
+public:
+  InvalidRecordRangeError()
+      : std::runtime_error{
+            "The --from and --count options must be non-negative integers"} {}
+};
+
+class BinPackContainerError : public std::runtime_error {
+public:
+  BinPackContainerError(std::string message, std::filesystem::path path)
+      : std::runtime_error{std::move(message)}, path_{std::move(path)} {}
+
+  [[nodiscard]] auto path() const noexcept -> const std::filesystem::path & {
+    return this->path_;
+  }
+
+private:
+  std::filesystem::path path_;
+};
+
 class InvalidLintRuleError : public std::runtime_error {
 public:
   InvalidLintRuleError(std::string message, std::string rule)
@@ -313,6 +340,27 @@ private:
   std::string dialect_;
 };
 
+class InvalidOpenAPIError : public std::runtime_error {
+public:
+  InvalidOpenAPIError(std::string message, std::filesystem::path path,
+                      sourcemeta::core::Pointer location)
+      : std::runtime_error{std::move(message)}, path_{std::move(path)},
+        location_{std::move(location)} {}
+
+  [[nodiscard]] auto path() const noexcept -> const std::filesystem::path & {
+    return this->path_;
+  }
+
+  [[nodiscard]] auto location() const noexcept
+      -> const sourcemeta::core::Pointer & {
+    return this->location_;
+  }
+
+private:
+  std::filesystem::path path_;
+  sourcemeta::core::Pointer location_;
+};
+
 class UnsupportedDialectUpgradeError : public std::runtime_error {
 public:
   UnsupportedDialectUpgradeError(std::filesystem::path path,
@@ -984,6 +1032,10 @@ inline auto try_catch(const sourcemeta::core::Options &options,
       std::cerr << "command to move your schema to a newer dialect\n";
     }
 
+    return EXIT_SCHEMA_INPUT_ERROR;
+  } catch (const InvalidOpenAPIError &error) {
+    const auto is_json{options.contains("json")};
+    print_exception(is_json, error);
     return EXIT_SCHEMA_INPUT_ERROR;
   } catch (const InvalidLintRuleError &error) {
     const auto is_json{options.contains("json")};
@@ -1249,6 +1301,10 @@ inline auto try_catch(const sourcemeta::core::Options &options,
     const auto is_json{options.contains("json")};
     print_exception(is_json, error);
     return EXIT_OTHER_INPUT_ERROR;
+  } catch (const BinPackContainerError &error) {
+    const auto is_json{options.contains("json")};
+    print_exception(is_json, error);
+    return EXIT_OTHER_INPUT_ERROR;
 
     // Command line parsing handling
   } catch (const StdinError &error) {
@@ -1263,6 +1319,14 @@ inline auto try_catch(const sourcemeta::core::Options &options,
     const auto is_json{options.contains("json")};
     print_exception(is_json, error);
     return EXIT_INVALID_CLI_ARGUMENTS;
+  } catch (const InvalidShardError &error) {
+    const auto is_json{options.contains("json")};
+    print_exception(is_json, error);
+    return EXIT_INVALID_CLI_ARGUMENTS;
+  } catch (const InvalidRecordRangeError &error) {
+    const auto is_json{options.contains("json")};
+    print_exception(is_json, error);
+    return EXIT_INVALID_CLI_ARGUMENTS;
   } catch (const InvalidOptionEnumerationValueError &error) {
     const auto is_json{options.contains("json")};
     print_exception(is_json, error);
@@ -11,21 +11,29 @@
 #include <sourcemeta/core/yaml.h>
 
 #include "configuration.h"
+#include "error.h"
 #include "logger.h"
+#include "timings.h"
 
 #include <algorithm>     // std::any_of, std::none_of, std::sort, std::count
+#include <array>         // std::array
+#include <charconv>      // std::from_chars
 #include <cstddef>       // std::size_t
-#include <cstdint>       // std::uintptr_t
+#include <cstdint>       // std::uintptr_t, std::uint64_t
 #include <deque>         // std::deque
 #include <filesystem>    // std::filesystem
-#include <functional>    // std::ref, std::hash
+#include <functional>    // std::ref, std::hash, std::function
 #include <iostream>      // std::cin
+#include <map>           // std::map
 #include <memory>        // std::shared_ptr, std::make_shared
 #include <optional>      // std::optional
 #include <set>           // std::set
 #include <sstream>       // std::ostringstream, std::istringstream
 #include <string>        // std::string
+#include <string_view>   // std::string_view
+#include <system_error>  // std::errc
 #include <unordered_set> // std::unordered_set
+#include <utility>       // std::pair
 #include <vector>        // std::vector
 
 namespace sourcemeta::jsonschema {
@@ -45,14 +53,25 @@ struct InputJSON {
   }
 };
 
+using ExtensionsCache =
+    std::map<std::pair<std::uintptr_t, std::optional<std::filesystem::path>>,
+             std::set<std::string>>;
+
+inline auto extensions_cache() -> ExtensionsCache & {
+  static ExtensionsCache cache;
+  return cache;
+}
+
+// Forget every set of extensions parsed so far, for `--watch/-W` to pick up
+// changes to configuration files
+inline auto reset_extensions() -> void { extensions_cache().clear(); }
+
 inline auto parse_extensions(
     const sourcemeta::core::Options &options,
     const std::optional<sourcemeta::blaze::Configuration> &configuration)
     -> const std::set<std::string> & {
-  using CacheKey =
-      std::pair<std::uintptr_t, std::optional<std::filesystem::path>>;
-  static std::map<CacheKey, std::set<std::string>> cache;
-
+  using CacheKey = ExtensionsCache::key_type;
+  auto &cache{extensions_cache()};
   CacheKey cache_key{reinterpret_cast<std::uintptr_t>(&options),
                      configuration.has_value()
                          ? std::optional{configuration.value().absolute_path}
@@ -135,6 +154,85 @@ merge_configuration_ignore(const std::filesystem::path &configuration_path,
   }
 }
 
+// Commands may skip files before parsing them, i.e. when a result cache
+// already knows their outcome
+using InputSkip = std::function<bool(const std::filesystem::path &)>;
+
+// Receive inputs one at a time, as soon as they are parsed. Returning false
+// stops reading any further input
+using InputVisitor = std::function<bool(InputJSON &&)>;
+
+// A deterministic subset of the inputs, selected with `--shard INDEX/COUNT`,
+// to split a single run across processes or machines. The shards of a run
+// are disjoint and together cover every input
+struct InputShard {
+  std::size_t index;
+  std::size_t count;
+
+  // Whether the shard owns the file at the given path, which should be
+  // relative so that the partition does not depend on where the inputs live.
+  // We implement FNV-1a rather than using `std::hash`, as the latter is not
+  // guaranteed to be the same across platforms
+  [[nodiscard]] auto owns(const std::filesystem::path &path) const -> bool {
+    std::uint64_t hash{14695981039346656037ULL};
+    for (const auto character : path.generic_string()) {
+      hash ^= static_cast<unsigned char>(character);
+      hash *= 1099511628211ULL;
+    }
+
+    return hash % this->count == this->index - 1;
+  }
+
+  // Whether the shard owns a file passed as an argument, which we identify by
+  // its path relative to the working directory
+  [[nodiscard]] auto owns_argument(const std::filesystem::path &canonical) const
+      -> bool {
+    return this->owns(canonical.lexically_relative(
+        sourcemeta::core::weakly_canonical(std::filesystem::current_path())));
+  }
+
+  // The first byte of the given share of a file of the given size, computed
+  // without overflowing on large files
+  [[nodiscard]] auto offset(const std::uint64_t size,
+                            const std::size_t share) const noexcept
+      -> std::uint64_t {
+    return size / this->count * share +
+           size % this->count * share / this->count;
+  }
+};
+
+inline auto parse_shard(const sourcemeta::core::Options &options)
+    -> std::optional<InputShard> {
+  if (!options.contains("shard") || options.at("shard").empty()) {
+    return std::nullopt;
+  }
+
+  const std::string_view value{options.at("shard").front()};
+  const auto separator{value.find('/')};
+  if (separator == std::string_view::npos) {
+    throw InvalidShardError{};
+  }
+
+  const auto parse{[](const std::string_view part) -> std::size_t {
+    std::size_t result{0};
+    const auto *const end{part.data() + part.size()};
+    const auto [pointer, error]{std::from_chars(part.data(), end, result)};
+    if (part.empty() || error != std::errc{} || pointer != end) {
+      throw InvalidShardError{};
+    }
+
+    return result;
+  }};
+
+  const InputShard result{.index = parse(value.substr(0, separator)),
+                          .count = parse(value.substr(separator + 1))};
+  if (result.index == 0 || result.index > result.count) {
+    throw InvalidShardError{};
+  }
+
+  return result;
+}
+
 namespace {
 
 struct ParsedJSON {
@@ -161,6 +259,7 @@ make_position_callback(sourcemeta::core::PointerPositionTracker &tracker,
 }
 
 inline auto read_file(const std::filesystem::path &path) -> ParsedJSON {
+  const TimingsScope timing{"parse", path};
   const auto extension{path.extension()};
   sourcemeta::core::PointerPositionTracker positions;
   auto property_storage = std::make_shared<std::deque<std::string>>();
@@ -196,6 +295,7 @@ inline auto read_file(const std::filesystem::path &path) -> ParsedJSON {
 
 // Read stdin into a buffer and try JSON first, then YAML
 inline auto read_from_stdin(std::string *raw_input = nullptr) -> ParsedJSON {
+  const TimingsScope timing{"parse", stdin_path()};
   const auto input{sourcemeta::core::read_stdin()};
   if (raw_input != nullptr) {
     *raw_input = input;
@@ -226,23 +326,106 @@ inline auto read_from_stdin(std::string *raw_input = nullptr) -> ParsedJSON {
   }
 }
 
+// The bytes of a JSONL file that a shard owns. A line belongs to the shard
+// whose share of the file contains its first byte. We also count the lines
+// and documents before the range, so that every shard reports the same
+// indexes and positions as processing the entire file would
+struct JSONLRange {
+  std::uint64_t begin{0};
+  std::uint64_t end{0};
+  std::uint64_t lines{0};
+  std::size_t documents{0};
+};
+
+inline auto jsonl_range(std::istream &stream, const std::uint64_t size,
+                        const InputShard &shard) -> JSONLRange {
+  const auto share_begin{shard.offset(size, shard.index - 1)};
+  const auto share_end{shard.offset(size, shard.index)};
+  JSONLRange result{.begin = size, .end = size};
+  bool found{false};
+  std::uint64_t lines{0};
+  std::size_t documents{0};
+  // Returns true once we know the end of the range
+  const auto on_line_start{[&](const std::uint64_t position) {
+    if (!found && position >= share_begin) {
+      result.begin = position;
+      result.lines = lines;
+      result.documents = documents;
+      found = true;
+    }
+
+    if (position >= share_end) {
+      result.end = position;
+      return true;
+    }
+
+    return false;
+  }};
+
+  if (on_line_start(0)) {
+    return result;
+  }
+
+  // Like the JSONL parser, we don't count blank lines as documents
+  bool blank{true};
+  std::uint64_t position{0};
+  std::array<char, 65536> buffer{};
+  while (stream.read(buffer.data(),
+                     static_cast<std::streamsize>(buffer.size())) ||
+         stream.gcount() > 0) {
+    const auto length{static_cast<std::size_t>(stream.gcount())};
+    for (std::size_t offset{0}; offset < length; offset++) {
+      const auto character{buffer[offset]};
+      position += 1;
+      if (character == '\n') {
+        lines += 1;
+        documents += blank ? 0 : 1;
+        blank = true;
+        if (on_line_start(position)) {
+          return result;
+        }
+      } else if (character != ' ' && character != '\t' && character != '\r') {
+        blank = false;
+      }
+    }
+  }
+
+  return result;
+}
+
+inline auto visit_each(std::vector<InputJSON> &entries,
+                       const InputVisitor &visitor) -> bool {
+  for (auto &entry : entries) {
+    if (!visitor(std::move(entry))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 inline auto
 handle_json_entry(const std::filesystem::path &entry_path,
                   const std::set<std::filesystem::path> &blacklist,
                   const std::set<std::string> &extensions,
-                  std::vector<sourcemeta::jsonschema::InputJSON> &result,
-                  const sourcemeta::core::Options &options) -> void {
+                  const sourcemeta::core::Options &options,
+                  const InputSkip &skip,
+                  const std::optional<InputShard> &shard,
+                  const InputVisitor &visitor) -> bool {
   if (entry_path == "-") {
     auto parsed{read_from_stdin()};
     const auto path{stdin_path()};
-    result.push_back({std::string{STDIN_DEFAULT_ID}, path,
-                      std::move(parsed.document), std::move(parsed.positions),
-                      0, false, parsed.yaml, true,
-                      std::move(parsed.property_storage)});
-    return;
+    return visitor({std::string{STDIN_DEFAULT_ID}, path,
+                    std::move(parsed.document), std::move(parsed.positions), 0,
+                    false, parsed.yaml, true,
+                    std::move(parsed.property_storage)});
   }
 
   if (std::filesystem::is_directory(entry_path)) {
+    // The directory walk order is unspecified, so we sort its files by path
+    // before handing them over
+    std::vector<InputJSON> result;
+    const auto root{sourcemeta::core::weakly_canonical(entry_path)};
     for (auto const &entry :
          std::filesystem::recursive_directory_iterator{entry_path}) {
       auto canonical{sourcemeta::core::weakly_canonical(entry.path())};
@@ -258,7 +441,10 @@ handle_json_entry(const std::filesystem::path &entry_path,
                          return sourcemeta::core::is_under_path(canonical,
                                                                 prefix);
                        })) {
-        if (std::filesystem::is_empty(canonical)) {
+        if ((shard.has_value() &&
+             !shard.value().owns(canonical.lexically_relative(root))) ||
+            std::filesystem::is_empty(canonical) ||
+            (skip && skip(canonical))) {
           continue;
         }
 
@@ -270,6 +456,10 @@ handle_json_entry(const std::filesystem::path &entry_path,
                           false, std::move(parsed.property_storage)});
       }
     }
+
+    std::sort(result.begin(), result.end(),
+              [](const auto &left, const auto &right) { return left < right; });
+    return visit_each(result, visitor);
   } else {
     const auto canonical{sourcemeta::core::weakly_canonical(entry_path)};
     if (std::none_of(blacklist.cbegin(), blacklist.cend(),
@@ -278,9 +468,22 @@ handle_json_entry(const std::filesystem::path &entry_path,
                                                               prefix);
                      })) {
       const auto canonical_string{canonical.generic_string()};
+      // We split JSONL files by lines rather than assigning them to a shard
+      const auto by_lines{!canonical_string.ends_with(".jsonl.gz") &&
+                          canonical.extension() == ".jsonl"};
+      if ((shard.has_value() && !by_lines &&
+           !shard.value().owns_argument(canonical)) ||
+          (skip && skip(canonical))) {
+        return true;
+      }
+
+      // JSONL parse errors surface while iterating, so we read every line
+      // before handing any document over
+      std::vector<InputJSON> result;
       if (canonical_string.ends_with(".jsonl.gz")) {
         LOG_VERBOSE(options) << "Interpreting input as GZIP-compressed JSONL: "
                              << canonical_string << "\n";
+        const TimingsScope timing{"parse", canonical};
         std::ifstream stream{sourcemeta::core::canonical(canonical),
                              std::ios::binary};
         stream.exceptions(std::ifstream::badbit);
@@ -311,14 +514,38 @@ handle_json_entry(const std::filesystem::path &entry_path,
         if (index == 0) {
           LOG_WARNING() << "The JSONL file is empty\n";
         }
+
+        return visit_each(result, visitor);
       } else if (canonical.extension() == ".jsonl") {
         LOG_VERBOSE(options)
             << "Interpreting input as JSONL: " << canonical.generic_string()
             << "\n";
+        const TimingsScope timing{"parse", canonical};
         auto stream{sourcemeta::core::read_file(canonical)};
         std::size_t index{0};
+        std::uint64_t line_offset{0};
+        std::istringstream slice;
+        std::istream *input{&stream};
+        if (shard.has_value()) {
+          const auto range{jsonl_range(
+              stream, std::filesystem::file_size(canonical), shard.value())};
+          LOG_VERBOSE(options)
+              << "Processing bytes " << range.begin << " to " << range.end
+              << " of JSONL input for shard " << shard.value().index << "/"
+              << shard.value().count << ": " << canonical_string << "\n";
+          std::string bytes(static_cast<std::size_t>(range.end - range.begin),
+                            '\0');
+          stream.clear();
+          stream.seekg(static_cast<std::streamoff>(range.begin));
+          stream.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+          slice.str(std::move(bytes));
+          input = &slice;
+          index = range.documents;
+          line_offset = range.lines;
+        }
+
         try {
-          for (const auto &document : sourcemeta::core::JSONL{stream}) {
+          for (const auto &document : sourcemeta::core::JSONL{*input}) {
             // TODO: Get real positions for JSONL
             sourcemeta::core::PointerPositionTracker positions;
             result.push_back({canonical.generic_string(),
@@ -333,87 +560,77 @@ handle_json_entry(const std::filesystem::path &entry_path,
             index += 1;
           }
         } catch (const sourcemeta::core::JSONParseError &error) {
-          throw sourcemeta::core::JSONFileParseError(canonical, error);
+          throw sourcemeta::core::JSONFileParseError(
+              canonical, error.line() + line_offset, error.column(),
+              error.what());
         }
 
-        if (index == 0) {
+        if (index == 0 && !shard.has_value()) {
           LOG_WARNING() << "The JSONL file is empty\n";
         }
+
+        return visit_each(result, visitor);
       } else if (canonical.extension() == ".yaml" ||
                  canonical.extension() == ".yml") {
         if (std::filesystem::is_empty(canonical)) {
-          return;
+          return true;
         }
-        auto stream{sourcemeta::core::read_file(canonical)};
-        struct MultiDocEntry {
-          sourcemeta::core::JSON document;
-          sourcemeta::core::PointerPositionTracker positions;
-          std::shared_ptr<std::deque<std::string>> property_storage;
-        };
-        std::vector<MultiDocEntry> documents;
-        std::uint64_t line_offset{0};
-        std::uint64_t max_line{0};
-        while (stream.peek() != std::char_traits<char>::eof()) {
+
+        // Hand over one document at a time, so that large multi-document
+        // files don't need to fit in memory and the first failure is
+        // reported right away
+        const sourcemeta::core::FileView view{canonical};
+        sourcemeta::core::YAMLStream stream{sourcemeta::core::JSON::StringView{
+            view.as<char>(), view.size()}};
+        std::size_t index{0};
+        while (!stream.done()) {
           sourcemeta::core::PointerPositionTracker positions;
           auto property_storage = std::make_shared<std::deque<std::string>>();
-          const std::uint64_t current_offset{line_offset};
-          max_line = 0;
-          auto callback =
-              [&positions, &property_storage, current_offset,
-               &max_line](const sourcemeta::core::JSON::ParsePhase phase,
-                          const sourcemeta::core::JSON::Type type,
-                          const std::uint64_t line, const std::uint64_t column,
-                          const sourcemeta::core::JSON::ParseContext context,
-                          const std::size_t index,
-                          const sourcemeta::core::JSON::String &property) {
-                max_line = std::max(max_line, line);
-                property_storage->emplace_back(property);
-                positions(phase, type, line + current_offset, column, context,
-                          index, property_storage->back());
-              };
+          const auto callback{
+              make_position_callback(positions, property_storage)};
           sourcemeta::core::JSON document{sourcemeta::core::JSON{nullptr}};
           try {
-            sourcemeta::core::parse_yaml(stream, document, callback);
+            const TimingsScope timing{"parse", canonical};
+            stream.next(document, callback);
           } catch (const sourcemeta::core::YAMLParseError &error) {
             throw sourcemeta::core::YAMLFileParseError{canonical, error};
           }
-          documents.push_back({std::move(document), std::move(positions),
-                               std::move(property_storage)});
-          line_offset += max_line > 0 ? max_line - 1 : 0;
-        }
 
-        if (documents.size() > 1) {
-          LOG_VERBOSE(options) << "Interpreting input as YAML multi-document: "
-                               << canonical.generic_string() << "\n";
-          std::size_t index{0};
-          for (auto &entry : documents) {
-            result.push_back({canonical.generic_string(), canonical,
-                              std::move(entry.document),
-                              std::move(entry.positions), index, true, true,
-                              false, std::move(entry.property_storage)});
-            index += 1;
+          // We only know whether there are more documents once we parsed
+          // the first one
+          const auto multidocument{index > 0 || !stream.done()};
+          if (index == 0 && multidocument) {
+            LOG_VERBOSE(options)
+                << "Interpreting input as YAML multi-document: "
+                << canonical_string << "\n";
+          }
+
+          if (!visitor({canonical_string, canonical, std::move(document),
+                        std::move(positions), index, multidocument, true,
+                        false, std::move(property_storage)})) {
+            return false;
           }
-        } else if (documents.size() == 1) {
-          result.push_back({canonical.generic_string(), std::move(canonical),
-                            std::move(documents.front().document),
-                            std::move(documents.front().positions), 0, false,
-                            true, false,
-                            std::move(documents.front().property_storage)});
+
+          index += 1;
         }
+
+        return true;
       } else {
         if (std::filesystem::is_regular_file(canonical) &&
             std::filesystem::is_empty(canonical)) {
-          return;
+          return true;
         }
         // TODO: Print a verbose message for what is getting parsed
         auto parsed{read_file(canonical)};
-        result.push_back({canonical.generic_string(), std::move(canonical),
-                          std::move(parsed.document),
-                          std::move(parsed.positions), 0, false, parsed.yaml,
-                          false, std::move(parsed.property_storage)});
+        return visitor({canonical_string, canonical,
+                        std::move(parsed.document), std::move(parsed.positions),
+                        0, false, parsed.yaml, false,
+                        std::move(parsed.property_storage)});
       }
     }
   }
+
+  return true;
 }
 
 } // namespace
@@ -426,14 +643,21 @@ check_no_duplicate_stdin(const std::vector<std::string_view> &arguments)
   }
 }
 
+// Hand every input over to the given visitor as soon as it is parsed, in the
+// same order in which the overloads below return them
 inline auto for_each_json(const std::vector<std::string_view> &arguments,
-                          const sourcemeta::core::Options &options)
-    -> std::vector<InputJSON> {
+                          const sourcemeta::core::Options &options,
+                          const InputSkip &skip,
+                          const std::optional<InputShard> &shard,
+                          const InputVisitor &visitor) -> void {
   check_no_duplicate_stdin(arguments);
+  if (shard.has_value() && std::find(arguments.cbegin(), arguments.cend(),
+                                     "-") != arguments.cend()) {
+    throw OptionConflictError{
+        "The `--shard` option cannot be used with standard input"};
+  }
 
   auto blacklist{parse_ignore(options)};
-  std::vector<InputJSON> result;
-
   if (arguments.empty()) {
     const auto current_path{std::filesystem::current_path()};
     const auto configuration_path{find_configuration(current_path)};
@@ -463,9 +687,8 @@ inline auto for_each_json(const std::vector<std::string_view> &arguments,
 
     const auto extensions{parse_extensions(options, configuration)};
 
-    handle_json_entry(scan_path, blacklist, extensions, result, options);
-    std::sort(result.begin(), result.end(),
-              [](const auto &left, const auto &right) { return left < right; });
+    handle_json_entry(scan_path, blacklist, extensions, options, skip, shard,
+                      visitor);
   } else {
     std::unordered_set<std::string> seen_configurations;
     for (const auto &entry : arguments) {
@@ -502,20 +725,33 @@ inline auto for_each_json(const std::vector<std::string_view> &arguments,
       const auto &entry_configuration{
           load_configuration(options, entry_configuration_path)};
       const auto &extensions{parse_extensions(options, entry_configuration)};
-      const auto before{result.size()};
-      handle_json_entry(entry, blacklist, extensions, result, options);
-      std::sort(
-          result.begin() + static_cast<std::ptrdiff_t>(before), result.end(),
-          [](const auto &left, const auto &right) { return left < right; });
+      if (!handle_json_entry(entry, blacklist, extensions, options, skip, shard,
+                             visitor)) {
+        return;
+      }
     }
   }
+}
 
+inline auto for_each_json(const std::vector<std::string_view> &arguments,
+                          const sourcemeta::core::Options &options,
+                          const InputSkip &skip = {},
+                          const std::optional<InputShard> &shard = std::nullopt)
+    -> std::vector<InputJSON> {
+  std::vector<InputJSON> result;
+  for_each_json(arguments, options, skip, shard,
+                [&result](InputJSON &&entry) {
+                  result.push_back(std::move(entry));
+                  return true;
+                });
   return result;
 }
 
-inline auto for_each_json(const sourcemeta::core::Options &options)
+inline auto for_each_json(const sourcemeta::core::Options &options,
+                          const InputSkip &skip = {},
+                          const std::optional<InputShard> &shard = std::nullopt)
     -> std::vector<InputJSON> {
-  return for_each_json(options.positional(), options);
+  return for_each_json(options.positional(), options, skip, shard);
 }
 
 } // namespace sourcemeta::jsonschema
@@ -4,6 +4,7 @@
 #include <sourcemeta/core/options.h>
 
 #include <fstream>  // std::ofstream
+#include <ios>      // std::ios_base, std::streamsize
 #include <iostream> // std::cerr
 #include <ostream>  // std::ostream
 
@@ -35,6 +36,31 @@ inline auto LOG_WARNING() -> std::ostream & {
   return std::cerr;
 }
 
+// Put back the formatting flags and precision of a stream once we are done
+// printing numbers to it, as the stream is usually shared with whatever the
+// command prints next
+class StreamFormatScope {
+public:
+  explicit StreamFormatScope(std::ostream &stream)
+      : stream_{stream}, flags_{stream.flags()},
+        precision_{stream.precision()} {}
+
+  ~StreamFormatScope() {
+    this->stream_.flags(this->flags_);
+    this->stream_.precision(this->precision_);
+  }
+
+  StreamFormatScope(const StreamFormatScope &) = delete;
+  StreamFormatScope(StreamFormatScope &&) = delete;
+  auto operator=(const StreamFormatScope &) -> StreamFormatScope & = delete;
+  auto operator=(StreamFormatScope &&) -> StreamFormatScope & = delete;
+
+private:
+  std::ostream &stream_;
+  std::ios_base::fmtflags flags_;
+  std::streamsize precision_;
+};
+
 } // namespace sourcemeta::jsonschema
 
 #endif
@@ -1,16 +1,26 @@
 #include <sourcemeta/blaze/foundation.h>
+#include <sourcemeta/core/json.h>
 #include <sourcemeta/core/options.h>
 
-#include <cstdlib>     // EXIT_SUCCESS
+#include <algorithm>   // std::find, std::any_of
+#include <cstdlib>     // EXIT_SUCCESS, EXIT_FAILURE
 #include <filesystem>  // std::filesystem
+#include <fstream>     // std::ofstream
+#include <iostream>    // std::cerr
 #include <print>       // std::print, std::println
 #include <string>      // std::string
 #include <string_view> // std::string_view
 
 #include "command.h"
+#include "configuration.h"
 #include "configure.h"
 #include "error.h"
+#include "input.h"
+#include "logger.h"
+#include "resolver.h"
+#include "timings.h"
 #include "utils.h"
+#include "watch.h"
 
 constexpr std::string_view USAGE_DETAILS{R"EOF(
 Global Options:
@@ -25,6 +35,13 @@ Global Options:
    --http, -h                     Allow network access to resolve remote schemas
    --header, -H <name: value>     Send a custom HTTP header on every outgoing
                                   request. May be passed multiple times
+   --timings, -T                  Print the wall time and CPU time spent on
+                                  every phase to standard error
+   --timings-trace <path>         Write every timed phase to the given file as
+                                  Chrome trace events
+   --watch, -W                    Run the command again every time its inputs
+                                  change. Only supported by `lint`, `test`
+                                  and `validate`
 
 Commands:
 
@@ -37,10 +54,12 @@ Commands:
        Print this command reference help.
 
    validate <schema.json|.yaml> <instance.json|.jsonl|.jsonl.gz|.yaml|directory...>
-            [--benchmark/-b] [--loop <iterations>] [--extension/-e <extension>]
+            [--benchmark/-b] [--loop <iterations>] [--warmup/-w <iterations>]
+            [--counters/-u] [--extension/-e <extension>]
             [--ignore/-i <schemas-or-directories>] [--trace/-t] [--fast/-f]
             [--template/-m <template.json>] [--entrypoint/-p <pointer|uri>]
-            [--continue/-c] [--format-assertion/-F]
+            [--continue/-c] [--format-assertion/-F] [--watch/-W]
+            [--shard <index/count>] [--ndjson] [--stream]
 
        Validate one or more instances against the given schema.
 
@@ -48,19 +67,34 @@ Commands:
        better error messages, at the expense of speed. The --fast/-f option
        makes the schema compiler optimise for speed, at the expense of error
        messages. Looping in benchmark mode allows to collect the execution time
-       average and standard deviation over multiple runs.
+       average, standard deviation and percentiles over multiple runs, after
+       the given number of warmup runs. Use --counters/-u to also read hardware
+       performance counters where the system allows it.
 
        You may additionally pass a pre-compiled schema template (see the
        `compile` command). However, you still need to pass the original schema
        for error reporting purposes. Make sure they match or you will get
        non-sense results.
 
+       Use --shard to only process a deterministic share of the instances,
+       to split a run across processes or machines. For example, run with
+       `--shard 1/2` and `--shard 2/2`. JSONL files are split by lines.
+
+       Use --ndjson to output one compact JSON result per line, rather than
+       the pretty-printed output of --json/-j.
+
+       Use --stream to validate a large top-level JSON array or object one
+       entry at a time, without ever holding the whole document in memory.
+       It implies --fast/-f and only applies to `.json` instances.
+
    metaschema [schemas-or-directories...] [--extension/-e <extension>]
               [--ignore/-i <schemas-or-directories>] [--trace/-t]
-              [--format-assertion/-F]
+              [--format-assertion/-F] [--cache <manifest.json>]
+              [--shard <index/count>]
 
        Validate that a schema or a set of schemas are valid with respect
-       to their metaschemas.
+       to their metaschemas. Use --cache to skip the schemas that passed
+       in a previous run and did not change since.
 
    compile <schema.json|.yaml> [--extension/-e <extension>]
            [--ignore/-i <schemas-or-directories>] [--fast/-f] [--minify/-m]
@@ -73,24 +107,28 @@ Commands:
 
    test [schemas-or-directories...] [--extension/-e <extension>]
         [--ignore/-i <schemas-or-directories>] [--format-assertion/-F]
-        [--jobs/-J <count>]
+        [--jobs/-J <count>] [--watch/-W] [--shard <index/count>]
 
        Run a set of unit tests against a schema.
        Pass --json/-j to output results in CTRF format (https://ctrf.io).
 
    fmt [schemas-or-directories...] [--check/-c] [--extension/-e <extension>]
        [--ignore/-i <schemas-or-directories>] [--keep-ordering/-k]
-       [--indentation/-n <spaces>]
+       [--indentation/-n <spaces>] [--cache <manifest.json>]
+       [--shard <index/count>]
 
        Format the input schemas in-place or check they are formatted.
        This command does not support YAML schemas yet.
+       Use --cache to skip the schemas that were formatted in a previous
+       run and did not change since.
 
    lint [schemas-or-directories...] [--fix/-f] [--format/-m]
         [--keep-ordering/-k] [--extension/-e <extension>]
         [--ignore/-i <schemas-or-directories>] [--exclude/-x <rule-name>]
         [--only/-o <rule-name>] [--list/-l] [--indentation/-n <spaces>]
         [--rule/-a <rule-schema>] [--top-level-rule/-t <rule-schema>]
-        [--format-assertion/-F]
+        [--format-assertion/-F] [--cache <manifest.json>] [--watch/-W]
+        [--shard <index/count>]
 
        Lint the input schemas and potentially fix the reported issues.
        The --fix/-f option is not supported when passing YAML schemas.
@@ -101,6 +139,8 @@ Commands:
        Use --rule/-a to add a custom lint rule defined as a JSON Schema.
        Use --top-level-rule/-t to add a custom lint rule that only runs
        against the document root.
+       Use --cache to skip the schemas that had no linting issues in a
+       previous run and did not change since.
 
    upgrade <schema.json|.yaml>
            [--to/-t draft4|draft6|draft7|2019-09|2020-12] [--meta/-m]
@@ -128,12 +168,19 @@ Commands:
        --target/-t set to typescript and JSON Schema 2020-12.
 
    encode <document.json|.jsonl> <output.binpack>
+          [--schema/-s <schema.json|.yaml>] [--jobs/-J <count>]
 
-       Encode a JSON document or JSONL dataset using JSON BinPack.
+       Encode a JSON document or JSONL dataset using JSON BinPack. Pass
+       --schema/-s to derive a schema-driven encoding instead of the
+       schema-less one. JSONL datasets are encoded into blocks in parallel.
 
    decode <output.binpack> <output.json|.jsonl>
+          [--schema/-s <schema.json|.yaml>] [--jobs/-J <count>]
+          [--from/-f <record>] [--count/-c <records>]
 
-       Decode a JSON document or JSONL dataset using JSON BinPack.
+       Decode a JSON document or JSONL dataset using JSON BinPack. The
+       --schema/-s option must match the one used for encoding. Use
+       --from/-f and --count/-c to only decode a range of JSONL records.
 
    rdf <schema.json|.yaml> <instance.json|.yaml> [--flatten/-l]
        [--compact/-c <context.json|.yaml>] [--fast/-f] [--format-assertion/-F]
@@ -146,6 +193,15 @@ Commands:
        exhaustive mode by default. Pass --fast/-f to optimise for speed at
        the expense of validation error quality.
 
+   openapi <openapi.json|.yaml> <traffic.jsonl|.jsonl.gz> [--fast/-f]
+           [--format-assertion/-F] [--jobs/-J <count>]
+
+       Validate a log of HTTP exchanges against the request and response
+       schemas of an OpenAPI 3.1 or 3.2 document. Every line is an object
+       with the method, path, optional status and optional body of an
+       exchange. Lines with a status are checked against the response
+       schemas and lines without one against the request schemas.
+
    install [<uri> <path>] [--force/-f] [--frozen/-z]
 
        Fetch and install external schema dependencies declared in
@@ -158,6 +214,140 @@ Commands:
 For more documentation, visit https://github.com/sourcemeta/jsonschema
 )EOF"};
 
+// Timings are enabled as soon as options are parsed, so that no phase of the
+// command goes unmeasured
+static auto parse(sourcemeta::core::Options &app, int argc, char *argv[])
+    -> void {
+  app.parse(argc, argv, {.skip = 1});
+  if (app.contains("timings") || app.contains("timings-trace")) {
+    sourcemeta::jsonschema::Timings::instance().enable();
+  }
+}
+
+static auto report_timings(const sourcemeta::core::Options &app) -> void {
+  const auto &timings{sourcemeta::jsonschema::Timings::instance()};
+  if (!timings.enabled()) {
+    return;
+  }
+
+  if (app.contains("timings")) {
+    sourcemeta::jsonschema::print_timings(timings, std::cerr);
+  }
+
+  if (app.contains("timings-trace") && !app.at("timings-trace").empty()) {
+    std::ofstream stream{
+        std::filesystem::path{app.at("timings-trace").front()}};
+    stream.exceptions(std::ios_base::badbit | std::ios_base::failbit);
+    sourcemeta::core::prettify(sourcemeta::jsonschema::to_trace_events(timings),
+                               stream);
+    stream << "\n";
+  }
+}
+
+// Changing these files might affect the outcome of any input, so we start
+// over rather than trying to figure out which inputs they affect
+static auto requires_reset(const sourcemeta::core::Options &app,
+                           const std::filesystem::path &path) -> bool {
+  // A configuration file might have just been created
+  if (path.filename() == "jsonschema.json") {
+    return true;
+  }
+
+  if (sourcemeta::jsonschema::reload_resolvers(path)) {
+    return false;
+  }
+
+  // A file that we could not import from before, maybe as it did not exist
+  return app.contains("resolve") &&
+         std::any_of(app.at("resolve").cbegin(), app.at("resolve").cend(),
+                     [&path](const auto &argument) {
+                       return sourcemeta::core::is_under_path(path, argument);
+                     });
+}
+
+// With `--watch/-W`, run the command again every time one of the files it
+// depends on changes. We do so in the same process, so that configuration
+// files, resolvers and compiled schemas remain resident, and commands only
+// process the inputs affected by the changes
+static auto watch(const sourcemeta::core::Options &app,
+                  void (*const command)(const sourcemeta::core::Options &),
+                  const bool current_directory) -> int {
+  if (!app.contains("watch")) {
+    command(app);
+    return EXIT_SUCCESS;
+  }
+
+  if (std::find(app.positional().cbegin(), app.positional().cend(), "-") !=
+      app.positional().cend()) {
+    throw sourcemeta::jsonschema::OptionConflictError{
+        "The `--watch/-W` option cannot be used with standard input"};
+  }
+
+  auto &session{sourcemeta::jsonschema::Watch::instance()};
+  session.enable();
+  sourcemeta::jsonschema::Watcher watcher;
+  for (const auto &argument : app.positional()) {
+    watcher.add(argument);
+  }
+
+  if (current_directory) {
+    watcher.add(std::filesystem::current_path());
+  }
+
+  if (app.contains("resolve")) {
+    for (const auto &argument : app.at("resolve")) {
+      watcher.add(argument);
+    }
+  }
+
+  while (true) {
+    const auto code{sourcemeta::jsonschema::try_catch(app, [&app, command]() {
+      command(app);
+      return EXIT_SUCCESS;
+    })};
+
+    for (const auto &path : session.paths()) {
+      watcher.add(path);
+    }
+
+    std::cerr << "Watching for changes...\n";
+    const auto changes{watcher.wait()};
+    if (!changes.has_value()) {
+      sourcemeta::jsonschema::LOG_VERBOSE(app)
+          << "Detected more changes than the file system could report\n";
+    } else {
+      for (const auto &path : changes.value()) {
+        sourcemeta::jsonschema::LOG_VERBOSE(app)
+            << "Detected change: " << path.generic_string() << "\n";
+      }
+    }
+
+    // A command that did not run to completion might not have processed
+    // every input, so we cannot tell what the changes affect. Neither can we
+    // if we don't know what changed
+    const auto reset{
+        (code != EXIT_SUCCESS &&
+         code != sourcemeta::jsonschema::EXIT_EXPECTED_FAILURE) ||
+        !changes.has_value() || !session.invalidate(changes.value()) ||
+        sourcemeta::jsonschema::try_catch(app, [&app, &changes]() {
+          for (const auto &path : changes.value()) {
+            if (requires_reset(app, path)) {
+              return EXIT_FAILURE;
+            }
+          }
+
+          return EXIT_SUCCESS;
+        }) != EXIT_SUCCESS};
+
+    if (reset) {
+      session.reset();
+      sourcemeta::jsonschema::reset_resolvers();
+      sourcemeta::jsonschema::reset_configurations();
+      sourcemeta::jsonschema::reset_extensions();
+    }
+  }
+}
+
 auto jsonschema_main(const std::string &program, const std::string &command,
                      sourcemeta::core::Options &app, int argc, char *argv[])
     -> int {
@@ -167,18 +357,20 @@ auto jsonschema_main(const std::string &program, const std::string &command,
     app.option("extension", {"e"});
     app.option("ignore", {"i"});
     app.option("indentation", {"n"});
-    app.parse(argc, argv, {.skip = 1});
+    app.option("cache", {});
+    app.option("shard", {});
+    parse(app, argc, argv);
     sourcemeta::jsonschema::fmt(app);
     return EXIT_SUCCESS;
   } else if (command == "inspect") {
-    app.parse(argc, argv, {.skip = 1});
+    parse(app, argc, argv);
     sourcemeta::jsonschema::inspect(app);
     return EXIT_SUCCESS;
   } else if (command == "bundle") {
     app.flag("without-id", {"w"});
     app.option("extension", {"e"});
     app.option("ignore", {"i"});
-    app.parse(argc, argv, {.skip = 1});
+    parse(app, argc, argv);
     sourcemeta::jsonschema::bundle(app);
     return EXIT_SUCCESS;
   } else if (command == "lint") {
@@ -194,11 +386,14 @@ auto jsonschema_main(const std::string &program, const std::string &command,
     app.option("indentation", {"n"});
     app.option("rule", {"a"});
     app.option("top-level-rule", {"t"});
-    app.parse(argc, argv, {.skip = 1});
-    sourcemeta::jsonschema::lint(app);
-    return EXIT_SUCCESS;
+    app.option("cache", {});
+    app.option("shard", {});
+    app.flag("watch", {"W"});
+    parse(app, argc, argv);
+    return watch(app, sourcemeta::jsonschema::lint, app.positional().empty());
   } else if (command == "validate") {
     app.flag("benchmark", {"b"});
+    app.flag("counters", {"u"});
     app.flag("trace", {"t"});
     app.flag("fast", {"f"});
     app.flag("format-assertion", {"F"});
@@ -207,16 +402,24 @@ auto jsonschema_main(const std::string &program, const std::string &command,
     app.option("ignore", {"i"});
     app.option("template", {"m"});
     app.option("loop", {"l"});
+    app.option("warmup", {"w"});
     app.option("entrypoint", {"p"});
-    app.parse(argc, argv, {.skip = 1});
-    sourcemeta::jsonschema::validate(app);
-    return EXIT_SUCCESS;
+    app.option("shard", {});
+    app.flag("ndjson", {});
+    app.flag("stream", {});
+    app.flag("watch", {"W"});
+    parse(app, argc, argv);
+    // Without instances, we validate every file in the current directory
+    return watch(app, sourcemeta::jsonschema::validate,
+                 app.positional().size() < 2);
   } else if (command == "metaschema") {
     app.flag("trace", {"t"});
     app.flag("format-assertion", {"F"});
     app.option("extension", {"e"});
     app.option("ignore", {"i"});
-    app.parse(argc, argv, {.skip = 1});
+    app.option("cache", {});
+    app.option("shard", {});
+    parse(app, argc, argv);
     sourcemeta::jsonschema::metaschema(app);
     return EXIT_SUCCESS;
   } else if (command == "compile") {
@@ -225,7 +428,7 @@ auto jsonschema_main(const std::string &program, const std::string &command,
     app.flag("minify", {"m"});
     app.option("include", {"n"});
     app.option("entrypoint", {"p"});
-    app.parse(argc, argv, {.skip = 1});
+    parse(app, argc, argv);
     sourcemeta::jsonschema::compile(app);
     return EXIT_SUCCESS;
   } else if (command == "test") {
@@ -233,33 +436,40 @@ auto jsonschema_main(const std::string &program, const std::string &command,
     app.option("extension", {"e"});
     app.option("ignore", {"i"});
     app.option("jobs", {"J"});
-    app.parse(argc, argv, {.skip = 1});
-    sourcemeta::jsonschema::test(app);
-    return EXIT_SUCCESS;
+    app.option("shard", {});
+    app.flag("watch", {"W"});
+    parse(app, argc, argv);
+    return watch(app, sourcemeta::jsonschema::test, app.positional().empty());
   } else if (command == "encode") {
-    app.parse(argc, argv, {.skip = 1});
+    app.option("schema", {"s"});
+    app.option("jobs", {"J"});
+    parse(app, argc, argv);
     sourcemeta::jsonschema::encode(app);
     return EXIT_SUCCESS;
   } else if (command == "decode") {
-    app.parse(argc, argv, {.skip = 1});
+    app.option("schema", {"s"});
+    app.option("jobs", {"J"});
+    app.option("from", {"f"});
+    app.option("count", {"c"});
+    parse(app, argc, argv);
     sourcemeta::jsonschema::decode(app);
     return EXIT_SUCCESS;
   } else if (command == "codegen") {
     app.option("name", {"n"});
     app.option("target", {"t"});
-    app.parse(argc, argv, {.skip = 1});
+    parse(app, argc, argv);
     sourcemeta::jsonschema::codegen(app);
     return EXIT_SUCCESS;
   } else if (command == "install") {
     app.flag("force", {"f"});
     app.flag("frozen", {"z"});
-    app.parse(argc, argv, {.skip = 1});
+    parse(app, argc, argv);
     sourcemeta::jsonschema::install(app);
     return EXIT_SUCCESS;
   } else if (command == "upgrade") {
     app.option("to", {"t"});
     app.flag("meta", {"m"});
-    app.parse(argc, argv, {.skip = 1});
+    parse(app, argc, argv);
     sourcemeta::jsonschema::upgrade(app);
     return EXIT_SUCCESS;
   } else if (command == "rdf") {
@@ -269,9 +479,16 @@ auto jsonschema_main(const std::string &program, const std::string &command,
     app.option("compact", {"c"});
     app.option("extension", {"e"});
     app.option("ignore", {"i"});
-    app.parse(argc, argv, {.skip = 1});
+    parse(app, argc, argv);
     sourcemeta::jsonschema::rdf(app);
     return EXIT_SUCCESS;
+  } else if (command == "openapi") {
+    app.flag("fast", {"f"});
+    app.flag("format-assertion", {"F"});
+    app.option("jobs", {"J"});
+    parse(app, argc, argv);
+    sourcemeta::jsonschema::openapi(app);
+    return EXIT_SUCCESS;
   } else if (command == "help" || command == "--help" || command == "-h") {
     std::println("JSON Schema CLI - v{}",
                  sourcemeta::jsonschema::PROJECT_VERSION);
@@ -297,10 +514,20 @@ auto main(int argc, char *argv[]) noexcept -> int {
   app.option("resolve", {"r"});
   app.option("default-dialect", {"d"});
   app.option("header", {"H"});
-
-  return sourcemeta::jsonschema::try_catch(app, [&app, argc, &argv]() {
-    const std::string program{argv[0]};
-    const std::string command{argc > 1 ? argv[1] : "help"};
-    return jsonschema_main(program, command, app, argc, argv);
+  app.flag("timings", {"T"});
+  app.option("timings-trace", {});
+
+  const auto code{
+      sourcemeta::jsonschema::try_catch(app, [&app, argc, &argv]() {
+        const std::string program{argv[0]};
+        const std::string command{argc > 1 ? argv[1] : "help"};
+        return jsonschema_main(program, command, app, argc, argv);
+      })};
+
+  // Report even if the command failed, as slow failures are worth
+  // measuring too
+  return sourcemeta::jsonschema::try_catch(app, [&app, code]() {
+    report_timings(app);
+    return code;
   });
 }
@@ -0,0 +1,47 @@
+#ifndef SOURCEMETA_JSONSCHEMA_CLI_METASCHEMAS_H_
+#define SOURCEMETA_JSONSCHEMA_CLI_METASCHEMAS_H_
+
+#include <sourcemeta/blaze/compiler.h>
+#include <sourcemeta/blaze/evaluator.h>
+#include <sourcemeta/core/json.h>
+
+#include <array>       // std::array
+#include <optional>    // std::optional
+#include <string_view> // std::string_view
+
+namespace sourcemeta::jsonschema {
+
+// The official metaschemas are compiled at build time, without format
+// assertions, so that validating against them never pays for compilation
+struct PrecompiledMetaschema {
+  std::string_view identifier;
+  std::string_view fast;
+  std::string_view exhaustive;
+};
+
+} // namespace sourcemeta::jsonschema
+
+// Generated by `metaschemas_generate.cc`
+#include "metaschemas_templates.h"
+
+namespace sourcemeta::jsonschema {
+
+// Returns no value if the given identifier is not a built-in metaschema, or
+// if its template was serialised by an incompatible version of Blaze
+inline auto precompiled_metaschema(const std::string_view identifier,
+                                   const sourcemeta::blaze::Mode mode)
+    -> std::optional<sourcemeta::blaze::Template> {
+  for (const auto &entry : PRECOMPILED_METASCHEMAS) {
+    if (entry.identifier == identifier) {
+      return sourcemeta::blaze::from_json(sourcemeta::core::parse_json(
+          mode == sourcemeta::blaze::Mode::FastValidation ? entry.fast
+                                                          : entry.exhaustive));
+    }
+  }
+
+  return std::nullopt;
+}
+
+} // namespace sourcemeta::jsonschema
+
+#endif
@@ -0,0 +1,110 @@
+#include <sourcemeta/blaze/bundle.h>
+#include <sourcemeta/blaze/compiler.h>
+#include <sourcemeta/blaze/foundation.h>
+#include <sourcemeta/blaze/frame.h>
+#include <sourcemeta/core/json.h>
+
+#include <cstddef>     // std::size_t
+#include <cstdlib>     // EXIT_SUCCESS, EXIT_FAILURE
+#include <exception>   // std::exception
+#include <fstream>     // std::ofstream
+#include <iomanip>     // std::hex, std::setw, std::setfill
+#include <iostream>    // std::cerr
+#include <sstream>     // std::ostringstream
+#include <string>      // std::string
+#include <string_view> // std::string_view
+
+// This program runs at build time. It compiles the official metaschemas whose
+// URIs are given as arguments in both modes, and writes the resulting
+// templates into a header that the CLI embeds. See `metaschemas.h`
+
+static auto compile_metaschema(const sourcemeta::core::JSON &metaschema,
+                               const sourcemeta::blaze::Mode mode)
+    -> std::string {
+  const sourcemeta::core::JSON bundled{sourcemeta::blaze::bundle(
+      metaschema, sourcemeta::blaze::schema_walker,
+      sourcemeta::blaze::schema_resolver,
+      sourcemeta::blaze::BundleMode::References)};
+  sourcemeta::blaze::SchemaFrame frame{
+      sourcemeta::blaze::SchemaFrame::Mode::References};
+  frame.analyse(bundled, sourcemeta::blaze::schema_walker,
+                sourcemeta::blaze::schema_resolver);
+  const auto schema_template{sourcemeta::blaze::compile(
+      bundled, sourcemeta::blaze::schema_walker,
+      sourcemeta::blaze::schema_resolver,
+      sourcemeta::blaze::default_schema_compiler, frame, frame.root(), mode)};
+  std::ostringstream result;
+  sourcemeta::core::stringify(sourcemeta::blaze::to_json(schema_template),
+                              result);
+  return result.str();
+}
+
+// We emit character arrays rather than string literals, as some compilers
+// impose a low limit on the length of a single string literal
+static auto write_array(std::ostream &stream, const std::string_view name,
+                        const std::string_view data) -> void {
+  stream << "static constexpr char " << name << "[]{";
+  for (std::size_t index = 0; index < data.size(); index++) {
+    if (index % 16 == 0) {
+      stream << "\n   ";
+    }
+
+    stream << " '\\x" << std::hex << std::setw(2) << std::setfill('0')
+           << static_cast<unsigned int>(static_cast<unsigned char>(data[index]))
+           << std::dec << "',";
+  }
+
+  stream << "};\n\n";
+}
+
+auto main(int argc, char *argv[]) -> int {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <output> [metaschema-uri...]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::ostringstream arrays;
+  std::ostringstream entries;
+  std::size_t count{0};
+
+  try {
+    for (int index = 2; index < argc; index++) {
+      const std::string_view uri{argv[index]};
+      const auto metaschema{sourcemeta::blaze::schema_resolver(uri)};
+      if (!metaschema.has_value()) {
+        std::cerr << "error: Not an official metaschema: " << uri << "\n";
+        return EXIT_FAILURE;
+      }
+
+      const std::string identifier{sourcemeta::blaze::identify(
+          metaschema.value(), sourcemeta::blaze::schema_resolver)};
+      const auto prefix{"METASCHEMA_" + std::to_string(count)};
+      write_array(arrays, prefix + "_FAST",
+                  compile_metaschema(metaschema.value(),
+                                     sourcemeta::blaze::Mode::FastValidation));
+      write_array(arrays, prefix + "_EXHAUSTIVE",
+                  compile_metaschema(metaschema.value(),
+                                     sourcemeta::blaze::Mode::Exhaustive));
+      entries << "    {\"" << identifier << "\",\n"
+              << "     {" << prefix << "_FAST, sizeof(" << prefix
+              << "_FAST)},\n"
+              << "     {" << prefix << "_EXHAUSTIVE, sizeof(" << prefix
+              << "_EXHAUSTIVE)}},\n";
+      count++;
+    }
+  } catch (const std::exception &error) {
+    std::cerr << "error: " << error.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream output{argv[1]};
+  output << "// Generated by `metaschemas_generate.cc`. Do not edit\n\n"
+         << "namespace sourcemeta::jsonschema {\n\n"
+         << arrays.str()
+         << "static constexpr std::array<PrecompiledMetaschema, " << count
+         << "> PRECOMPILED_METASCHEMAS{{\n"
+         << entries.str() << "}};\n\n"
+         << "} // namespace sourcemeta::jsonschema\n";
+  output.flush();
+  return output ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,111 @@
+#ifndef SOURCEMETA_JSONSCHEMA_CLI_RECORDS_H_
+#define SOURCEMETA_JSONSCHEMA_CLI_RECORDS_H_
+
+#include <sourcemeta/core/json.h>
+
+#include <cstddef>   // std::size_t
+#include <ios>       // std::streamsize
+#include <optional>  // std::optional
+#include <ostream>   // std::ostream
+#include <streambuf> // std::streambuf
+#include <string>    // std::string
+
+namespace sourcemeta::jsonschema {
+
+// Write results as compact JSON records, one per line (NDJSON), for commands
+// that report on a large number of inputs. Records are serialised into a
+// single buffer that we reuse for the whole run and flush in batches, as
+// writing every record to the output on its own would dominate the cost of
+// validating a large JSONL dataset
+class RecordWriter {
+public:
+  explicit RecordWriter(std::ostream &output) : output_{output} {
+    this->buffer_.reserve(FLUSH_THRESHOLD + FLUSH_THRESHOLD / 4);
+  }
+
+  // Flush on the way out, including on errors, so that the records written
+  // so far are not lost
+  ~RecordWriter() {
+    try {
+      this->flush();
+    } catch (...) {
+      // Destructors must not throw
+    }
+  }
+
+  RecordWriter(const RecordWriter &) = delete;
+  RecordWriter(RecordWriter &&) = delete;
+  auto operator=(const RecordWriter &) -> RecordWriter & = delete;
+  auto operator=(RecordWriter &&) -> RecordWriter & = delete;
+
+  // Write the given output of a standard format, such as `Flag` or `Basic`,
+  // annotated with the input it refers to. Documents that are part of a
+  // multi-document input, such as JSONL, also record their 1-based index
+  auto write(const std::string &path, const std::optional<std::size_t> index,
+             const sourcemeta::core::JSON &output) -> void {
+    auto record{sourcemeta::core::JSON::make_object()};
+    record.assign("path", sourcemeta::core::JSON{path});
+    if (index.has_value()) {
+      record.assign("index", sourcemeta::core::JSON{index.value()});
+    }
+
+    for (const auto &property : output.as_object()) {
+      record.assign(property.first, property.second);
+    }
+
+    sourcemeta::core::stringify(record, this->stream_);
+    this->buffer_.push_back('\n');
+    if (this->buffer_.size() >= FLUSH_THRESHOLD) {
+      this->flush();
+    }
+  }
+
+  auto flush() -> void {
+    if (this->buffer_.empty()) {
+      return;
+    }
+
+    this->output_.write(this->buffer_.data(),
+                        static_cast<std::streamsize>(this->buffer_.size()));
+    this->output_.flush();
+    // Clearing keeps the capacity, so we don't allocate again
+    this->buffer_.clear();
+  }
+
+private:
+  static constexpr std::size_t FLUSH_THRESHOLD{65536};
+
+  // Append everything written to the stream to the buffer, without the
+  // intermediate copies of a string stream
+  class Appender : public std::streambuf {
+  public:
+    explicit Appender(std::string &target) : target_{target} {}
+
+  protected:
+    auto overflow(const int_type character) -> int_type override {
+      if (!traits_type::eq_int_type(character, traits_type::eof())) {
+        this->target_.push_back(traits_type::to_char_type(character));
+      }
+
+      return traits_type::not_eof(character);
+    }
+
+    auto xsputn(const char_type *data, const std::streamsize size)
+        -> std::streamsize override {
+      this->target_.append(data, static_cast<std::size_t>(size));
+      return size;
+    }
+
+  private:
+    std::string &target_;
+  };
+
+  std::ostream &output_;
+  std::string buffer_;
+  Appender appender_{this->buffer_};
+  std::ostream stream_{&this->appender_};
+};
+
+} // namespace sourcemeta::jsonschema
+
+#endif
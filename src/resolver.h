@@ -15,6 +15,7 @@
 #include "input.h"
 #include "logger.h"
 #include "utils.h"
+#include "watch.h"
 
 #include <cassert>     // assert
 #include <chrono>      // std::chrono::seconds
@@ -209,6 +210,7 @@ static inline auto fetch_schema(const sourcemeta::core::Options &options,
     const auto path{uri.to_path()};
     LOG_DEBUG(options) << "Attempting to read file reference from disk: "
                        << path.generic_string() << "\n";
+    WatchScope::depend(path);
     if (std::filesystem::exists(path)) {
       return sourcemeta::core::read_yaml_or_json(path);
     }
@@ -265,86 +267,20 @@ public:
       const sourcemeta::core::Options &options,
       const std::optional<sourcemeta::blaze::Configuration> &configuration,
       const bool remote, const std::string_view default_dialect)
-      : options_{options}, configuration_{configuration}, remote_{remote} {
+      : options_{options}, configuration_{configuration}, remote_{remote},
+        default_dialect_{default_dialect} {
     if (options.contains("resolve")) {
       for (const auto &entry : for_each_json(options.at("resolve"), options)) {
-        LOG_DEBUG(options) << "Detecting schema resources from file: "
-                           << entry.first << "\n";
-
-        if (!sourcemeta::blaze::is_schema(entry.second)) {
-          throw sourcemeta::core::FileError<sourcemeta::blaze::SchemaError>(
-              entry.resolution_base,
-              "The file you provided does not represent a valid JSON Schema");
-        }
-
-        try {
-          const auto result = this->add(
-              entry.second, default_dialect,
-              sourcemeta::jsonschema::default_id(entry),
-              [&options](const auto &identifier) {
-                LOG_DEBUG(options)
-                    << "Importing schema into the resolution context: "
-                    << identifier << "\n";
-              });
-          if (!result) {
-            LOG_WARNING()
-                << "No schema resources were imported from this file\n"
-                << "  at " << entry.first << "\n"
-                << "Are you sure this schema sets any identifiers?\n";
-          }
-        } catch (const sourcemeta::blaze::SchemaKeywordError &error) {
-          throw sourcemeta::core::FileError<
-              sourcemeta::blaze::SchemaKeywordError>(entry.resolution_base,
-                                                     error);
-        } catch (const sourcemeta::blaze::SchemaFrameError &error) {
-          throw sourcemeta::core::FileError<
-              sourcemeta::blaze::SchemaFrameError>(
-              entry.resolution_base, error.identifier(), error.what());
-        } catch (const sourcemeta::blaze::SchemaAnchorCollisionError &error) {
-          const auto position{entry.positions.get(error.location())};
-          if (position.has_value()) {
-            throw PositionError<sourcemeta::core::FileError<
-                sourcemeta::blaze::SchemaAnchorCollisionError>>(
-                std::get<0>(position.value()), std::get<1>(position.value()),
-                entry.resolution_base, error);
-          }
-
-          throw sourcemeta::core::FileError<
-              sourcemeta::blaze::SchemaAnchorCollisionError>(
-              entry.resolution_base, error);
-        } catch (const sourcemeta::blaze::SchemaReferenceError &error) {
-          throw sourcemeta::core::FileError<
-              sourcemeta::blaze::SchemaReferenceError>(
-              entry.resolution_base, error.identifier(), error.location(),
-              error.what());
-        } catch (const sourcemeta::blaze::SchemaUnknownBaseDialectError &) {
-          throw sourcemeta::core::FileError<
-              sourcemeta::blaze::SchemaUnknownBaseDialectError>(
-              entry.resolution_base);
-        } catch (const sourcemeta::blaze::SchemaUnknownDialectError &) {
-          throw sourcemeta::core::FileError<
-              sourcemeta::blaze::SchemaUnknownDialectError>(
-              entry.resolution_base);
-        } catch (
-            const sourcemeta::blaze::SchemaRelativeMetaschemaResolutionError
-                &error) {
-          throw sourcemeta::core::FileError<
-              sourcemeta::blaze::SchemaRelativeMetaschemaResolutionError>(
-              entry.resolution_base, error);
-        } catch (const sourcemeta::blaze::SchemaResolutionError &error) {
-          throw sourcemeta::core::FileError<
-              sourcemeta::blaze::SchemaResolutionError>(
-              entry.resolution_base, error.identifier(), error.what());
-        } catch (const sourcemeta::blaze::SchemaError &error) {
-          throw sourcemeta::core::FileError<sourcemeta::blaze::SchemaError>(
-              entry.resolution_base, error.what());
-        }
+        this->import(entry);
       }
     }
 
     if (this->configuration_.has_value()) {
       for (const auto &[dependency_uri, dependency_path] :
            this->configuration_.value().dependencies) {
+        // Dependencies are only meant to change through `install`, so we
+        // don't bother re-importing them individually
+        Watch::instance().depend_globally(dependency_path);
         if (!std::filesystem::exists(dependency_path)) {
           continue;
         }
@@ -427,6 +363,11 @@ public:
     }
 
     if (this->schemas.contains(target)) {
+      const auto origin{this->origins_.find(target)};
+      if (origin != this->origins_.cend()) {
+        WatchScope::depend(origin->second);
+      }
+
       return this->schemas.at(target);
     }
 
@@ -438,30 +379,151 @@ public:
     return fetched;
   }
 
+  // Import again the schema resources that came from the given file, for
+  // `--watch/-W` to pick up changes to it without re-importing every other
+  // file. Returns false if no schema resource came from the given file
+  auto reload(const std::filesystem::path &path) -> bool {
+    bool found{false};
+    for (auto iterator{this->origins_.begin()};
+         iterator != this->origins_.end();) {
+      if (iterator->second == path) {
+        this->schemas.erase(iterator->first);
+        iterator = this->origins_.erase(iterator);
+        found = true;
+      } else {
+        ++iterator;
+      }
+    }
+
+    if (found && std::filesystem::exists(path)) {
+      const auto path_string{path.string()};
+      for (const auto &entry : for_each_json({path_string}, this->options_)) {
+        this->import(entry);
+      }
+    }
+
+    return found;
+  }
+
 private:
+  auto import(const InputJSON &entry) -> void {
+    LOG_DEBUG(this->options_)
+        << "Detecting schema resources from file: " << entry.first << "\n";
+
+    if (!sourcemeta::blaze::is_schema(entry.second)) {
+      throw sourcemeta::core::FileError<sourcemeta::blaze::SchemaError>(
+          entry.resolution_base,
+          "The file you provided does not represent a valid JSON Schema");
+    }
+
+    try {
+      const auto result = this->add(
+          entry.second, this->default_dialect_,
+          sourcemeta::jsonschema::default_id(entry),
+          [this, &entry](const auto &identifier) {
+            LOG_DEBUG(this->options_)
+                << "Importing schema into the resolution context: "
+                << identifier << "\n";
+            this->origins_.insert_or_assign(identifier, entry.resolution_base);
+          });
+      if (!result) {
+        LOG_WARNING() << "No schema resources were imported from this file\n"
+                      << "  at " << entry.first << "\n"
+                      << "Are you sure this schema sets any identifiers?\n";
+      }
+    } catch (const sourcemeta::blaze::SchemaKeywordError &error) {
+      throw sourcemeta::core::FileError<sourcemeta::blaze::SchemaKeywordError>(
+          entry.resolution_base, error);
+    } catch (const sourcemeta::blaze::SchemaFrameError &error) {
+      throw sourcemeta::core::FileError<sourcemeta::blaze::SchemaFrameError>(
+          entry.resolution_base, error.identifier(), error.what());
+    } catch (const sourcemeta::blaze::SchemaAnchorCollisionError &error) {
+      const auto position{entry.positions.get(error.location())};
+      if (position.has_value()) {
+        throw PositionError<sourcemeta::core::FileError<
+            sourcemeta::blaze::SchemaAnchorCollisionError>>(
+            std::get<0>(position.value()), std::get<1>(position.value()),
+            entry.resolution_base, error);
+      }
+
+      throw sourcemeta::core::FileError<
+          sourcemeta::blaze::SchemaAnchorCollisionError>(
+          entry.resolution_base, error);
+    } catch (const sourcemeta::blaze::SchemaReferenceError &error) {
+      throw sourcemeta::core::FileError<
+          sourcemeta::blaze::SchemaReferenceError>(
+          entry.resolution_base, error.identifier(), error.location(),
+          error.what());
+    } catch (const sourcemeta::blaze::SchemaUnknownBaseDialectError &) {
+      throw sourcemeta::core::FileError<
+          sourcemeta::blaze::SchemaUnknownBaseDialectError>(
+          entry.resolution_base);
+    } catch (const sourcemeta::blaze::SchemaUnknownDialectError &) {
+      throw sourcemeta::core::FileError<
+          sourcemeta::blaze::SchemaUnknownDialectError>(
+          entry.resolution_base);
+    } catch (const sourcemeta::blaze::SchemaRelativeMetaschemaResolutionError
+                 &error) {
+      throw sourcemeta::core::FileError<
+          sourcemeta::blaze::SchemaRelativeMetaschemaResolutionError>(
+          entry.resolution_base, error);
+    } catch (const sourcemeta::blaze::SchemaResolutionError &error) {
+      throw sourcemeta::core::FileError<
+          sourcemeta::blaze::SchemaResolutionError>(
+          entry.resolution_base, error.identifier(), error.what());
+    } catch (const sourcemeta::blaze::SchemaError &error) {
+      throw sourcemeta::core::FileError<sourcemeta::blaze::SchemaError>(
+          entry.resolution_base, error.what());
+    }
+  }
+
   std::map<std::string, sourcemeta::core::JSON> schemas{};
+  // The `--resolve` file that every imported identifier came from
+  std::map<std::string, std::filesystem::path> origins_;
   const sourcemeta::core::Options &options_;
   const std::optional<sourcemeta::blaze::Configuration> configuration_;
   bool remote_{false};
+  const std::string default_dialect_;
 };
 
+using ResolverCache = std::map<std::pair<bool, std::string>, CustomResolver>;
+
+inline auto resolver_cache() -> ResolverCache & {
+  static ResolverCache cache;
+  return cache;
+}
+
+// Forget every resolver built so far, for `--watch/-W` to start over. This
+// invalidates references to cached resolvers
+inline auto reset_resolvers() -> void { resolver_cache().clear(); }
+
+// See `CustomResolver::reload`
+inline auto reload_resolvers(const std::filesystem::path &path) -> bool {
+  bool found{false};
+  for (auto &entry : resolver_cache()) {
+    found = entry.second.reload(path) || found;
+  }
+
+  return found;
+}
+
 inline auto
 resolver(const sourcemeta::core::Options &options, const bool remote,
          const std::string_view default_dialect,
          const std::optional<sourcemeta::blaze::Configuration> &configuration)
     -> const CustomResolver & {
-  using CacheKey = std::pair<bool, std::string>;
-  static std::map<CacheKey, CustomResolver> resolver_cache;
+  using CacheKey = ResolverCache::key_type;
+  auto &cache{resolver_cache()};
   const CacheKey cache_key{remote, std::string{default_dialect}};
 
   // Check if resolver is already cached
-  auto iterator{resolver_cache.find(cache_key)};
-  if (iterator != resolver_cache.end()) {
+  auto iterator{cache.find(cache_key)};
+  if (iterator != cache.end()) {
     return iterator->second;
   }
 
   // Construct resolver directly in cache
-  auto [inserted_iterator, inserted] = resolver_cache.emplace(
+  auto [inserted_iterator, inserted] = cache.emplace(
       std::piecewise_construct, std::forward_as_tuple(cache_key),
       std::forward_as_tuple(options, configuration, remote, default_dialect));
   return inserted_iterator->second;
@@ -0,0 +1,115 @@
+#ifndef SOURCEMETA_JSONSCHEMA_CLI_TEMPLATE_CACHE_H_
+#define SOURCEMETA_JSONSCHEMA_CLI_TEMPLATE_CACHE_H_
+
+#include <sourcemeta/blaze/compiler.h>
+#include <sourcemeta/blaze/evaluator.h>
+#include <sourcemeta/blaze/test.h>
+
+#include <sourcemeta/core/json.h>
+
+#include "resolver.h"
+#include "watch.h"
+
+#include <filesystem> // std::filesystem
+#include <functional> // std::function
+#include <map>        // std::map
+#include <memory>     // std::shared_ptr, std::make_shared, std::unique_ptr
+#include <mutex>      // std::mutex, std::lock_guard
+#include <optional>   // std::optional
+#include <set>        // std::set
+#include <sstream>    // std::ostringstream
+#include <string>     // std::string
+#include <utility>    // std::pair, std::move
+
+namespace sourcemeta::jsonschema {
+
+// Test suites in a repository commonly target the same few schemas, so we
+// compile every target at most once per mode across the whole run, even when
+// suites that share a target run in parallel
+class TemplateCache {
+public:
+  // The same target might resolve to different schemas depending on the
+  // resolver in use, which is in turn shared by suites of the same setup
+  auto provider(const CustomResolver &schema_resolver)
+      -> sourcemeta::blaze::TestSuite::TemplateProvider {
+    return [this, &schema_resolver](
+               const sourcemeta::core::JSON::String &target,
+               const sourcemeta::blaze::Mode mode,
+               const std::optional<sourcemeta::blaze::Tweaks> &tweaks,
+               const std::function<sourcemeta::blaze::Template()> &compile)
+               -> std::shared_ptr<const sourcemeta::blaze::Template> {
+      auto &entry{this->at(
+          {&schema_resolver, tweaks_key(mode, tweaks) + ' ' + target})};
+      // Suites that need a template that another suite is compiling wait
+      // for it rather than compiling it again. If compilation throws, the
+      // next suite to ask for the template will try again
+      const std::lock_guard<std::mutex> lock{entry.mutex};
+      if (!entry.schema_template) {
+        const WatchScope watch_scope;
+        entry.schema_template =
+            std::make_shared<const sourcemeta::blaze::Template>(compile());
+        entry.dependencies = watch_scope.dependencies();
+      } else {
+        // Every suite that uses the template depends on what compiling it
+        // read, even if it did not compile it itself
+        for (const auto &dependency : entry.dependencies) {
+          WatchScope::depend(dependency);
+        }
+      }
+
+      return entry.schema_template;
+    };
+  }
+
+private:
+  using Key =
+      std::pair<const CustomResolver *, std::string>;
+
+  struct Entry {
+    std::mutex mutex;
+    std::shared_ptr<const sourcemeta::blaze::Template> schema_template;
+    std::set<std::filesystem::path> dependencies;
+  };
+
+  auto at(Key key) -> Entry & {
+    const std::lock_guard<std::mutex> lock{this->mutex};
+    auto &entry{this->entries[std::move(key)]};
+    if (!entry) {
+      entry = std::make_unique<Entry>();
+    }
+
+    return *entry;
+  }
+
+  static auto tweaks_key(const sourcemeta::blaze::Mode mode,
+                         const std::optional<sourcemeta::blaze::Tweaks> &tweaks)
+      -> std::string {
+    std::ostringstream result;
+    result << static_cast<int>(mode);
+    if (!tweaks.has_value()) {
+      return result.str();
+    }
+
+    const auto &value{tweaks.value()};
+    result << ':' << value.properties_always_unroll << value.properties_reorder
+           << value.format_assertion << ':' << value.target_inline_threshold;
+    if (value.annotations.has_value()) {
+      // The annotations are an unordered set, so we sort them to get a
+      // stable key
+      const std::set<sourcemeta::core::JSON::StringView> annotations{
+          value.annotations.value().cbegin(), value.annotations.value().cend()};
+      for (const auto &keyword : annotations) {
+        result << ':' << keyword;
+      }
+    }
+
+    return result.str();
+  }
+
+  std::mutex mutex;
+  std::map<Key, std::unique_ptr<Entry>> entries;
+};
+
+} // namespace sourcemeta::jsonschema
+
+#endif
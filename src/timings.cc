@@ -0,0 +1,71 @@
+#include "timings.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+// Keep this include after windows.h
+#include <psapi.h>
+#else
+#include <sys/resource.h> // getrusage, rusage, RUSAGE_SELF
+#endif
+
+#include <cstdint> // std::uint64_t
+
+namespace sourcemeta::jsonschema {
+
+auto timings_cpu_time() -> std::uint64_t {
+#if defined(_WIN32)
+  FILETIME creation, exit, kernel, user;
+  if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user) ==
+      0) {
+    return 0;
+  }
+
+  // In units of 100 nanoseconds
+  const auto to_microseconds{[](const FILETIME &time) {
+    return ((static_cast<std::uint64_t>(time.dwHighDateTime) << 32) |
+            time.dwLowDateTime) /
+           10;
+  }};
+
+  return to_microseconds(kernel) + to_microseconds(user);
+#else
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+
+  const auto to_microseconds{[](const timeval &time) {
+    return static_cast<std::uint64_t>(time.tv_sec) * 1000000 +
+           static_cast<std::uint64_t>(time.tv_usec);
+  }};
+
+  return to_microseconds(usage.ru_utime) + to_microseconds(usage.ru_stime);
+#endif
+}
+
+auto timings_peak_rss() -> std::uint64_t {
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters{};
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ==
+      0) {
+    return 0;
+  }
+
+  return static_cast<std::uint64_t>(counters.PeakWorkingSetSize);
+#else
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+
+#if defined(__APPLE__)
+  // Reported in bytes on macOS
+  return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+  // Reported in kilobytes everywhere else
+  return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+} // namespace sourcemeta::jsonschema
@@ -0,0 +1,244 @@
+#ifndef SOURCEMETA_JSONSCHEMA_CLI_TIMINGS_H_
+#define SOURCEMETA_JSONSCHEMA_CLI_TIMINGS_H_
+
+#include <sourcemeta/core/json.h>
+
+#include <algorithm>   // std::find_if
+#include <atomic>      // std::atomic
+#include <chrono>      // std::chrono
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint64_t
+#include <filesystem>  // std::filesystem::path
+#include <iomanip>     // std::setw
+#include <iterator>    // std::prev
+#include <map>         // std::map
+#include <mutex>       // std::mutex, std::lock_guard
+#include <ostream>     // std::ostream
+#include <string>      // std::string
+#include <string_view> // std::string_view
+#include <thread>      // std::this_thread, std::thread::id
+#include <utility>     // std::move
+#include <vector>      // std::vector
+
+#include "logger.h"
+
+namespace sourcemeta::jsonschema {
+
+// These are implemented per platform in `timings.cc`
+
+// The user plus system CPU time consumed by the process, in microseconds
+auto timings_cpu_time() -> std::uint64_t;
+// The peak resident set size of the process, in bytes
+auto timings_peak_rss() -> std::uint64_t;
+
+struct TimingsPhase {
+  std::string_view name;
+  // The file the phase operated on, if any
+  std::string detail;
+  std::size_t thread;
+  // Microseconds since timings were enabled
+  double start;
+  double wall;
+  double cpu;
+  std::uint64_t peak_rss;
+};
+
+// A process-wide collector of phase measurements. Recording is disabled by
+// default, so that instrumented code paths only pay for an atomic load
+class Timings {
+public:
+  static auto instance() -> Timings & {
+    static Timings timings;
+    return timings;
+  }
+
+  auto enable() -> void {
+    if (this->enabled()) {
+      return;
+    }
+
+    this->origin_ = std::chrono::steady_clock::now();
+    this->origin_cpu_ = timings_cpu_time();
+    this->enabled_.store(true, std::memory_order_release);
+  }
+
+  [[nodiscard]] auto enabled() const noexcept -> bool {
+    return this->enabled_.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] auto origin() const noexcept
+      -> std::chrono::steady_clock::time_point {
+    return this->origin_;
+  }
+
+  [[nodiscard]] auto origin_cpu() const noexcept -> std::uint64_t {
+    return this->origin_cpu_;
+  }
+
+  auto record(TimingsPhase &&phase, const std::thread::id thread) -> void {
+    std::lock_guard<std::mutex> lock{this->mutex_};
+    // Number threads in order of appearance, as trace viewers expect
+    // small integers
+    const auto match{this->threads_.try_emplace(thread, this->threads_.size())};
+    phase.thread = match.first->second;
+    this->phases_.push_back(std::move(phase));
+  }
+
+  [[nodiscard]] auto phases() const -> const std::vector<TimingsPhase> & {
+    return this->phases_;
+  }
+
+private:
+  Timings() = default;
+  std::atomic<bool> enabled_{false};
+  std::chrono::steady_clock::time_point origin_;
+  std::uint64_t origin_cpu_{0};
+  std::mutex mutex_;
+  std::map<std::thread::id, std::size_t> threads_;
+  std::vector<TimingsPhase> phases_;
+};
+
+// Measure the enclosing scope as the given phase. The CPU time and peak RSS
+// are process-wide, so phases that run concurrently on multiple threads
+// attribute each other's work
+class TimingsScope {
+public:
+  TimingsScope(const std::string_view name, const std::string_view detail = {})
+      : name_{name}, active_{Timings::instance().enabled()} {
+    if (this->active_) {
+      this->detail_ = detail;
+      this->begin();
+    }
+  }
+
+  TimingsScope(const std::string_view name,
+               const std::filesystem::path &detail)
+      : name_{name}, active_{Timings::instance().enabled()} {
+    if (this->active_) {
+      this->detail_ = detail.generic_string();
+      this->begin();
+    }
+  }
+
+  ~TimingsScope() {
+    if (!this->active_) {
+      return;
+    }
+
+    const auto end{std::chrono::steady_clock::now()};
+    auto &timings{Timings::instance()};
+    const std::chrono::duration<double, std::micro> start{this->start_ -
+                                                          timings.origin()};
+    const std::chrono::duration<double, std::micro> wall{end - this->start_};
+    timings.record({.name = this->name_,
+                    .detail = std::move(this->detail_),
+                    .thread = 0,
+                    .start = start.count(),
+                    .wall = wall.count(),
+                    .cpu = static_cast<double>(timings_cpu_time() -
+                                               this->start_cpu_),
+                    .peak_rss = timings_peak_rss()},
+                   std::this_thread::get_id());
+  }
+
+  TimingsScope(const TimingsScope &) = delete;
+  TimingsScope(TimingsScope &&) = delete;
+  auto operator=(const TimingsScope &) -> TimingsScope & = delete;
+  auto operator=(TimingsScope &&) -> TimingsScope & = delete;
+
+private:
+  auto begin() -> void {
+    this->start_cpu_ = timings_cpu_time();
+    this->start_ = std::chrono::steady_clock::now();
+  }
+
+  std::string_view name_;
+  bool active_;
+  std::string detail_;
+  std::chrono::steady_clock::time_point start_;
+  std::uint64_t start_cpu_{0};
+};
+
+// Print a table that aggregates every recorded phase by name, in order of
+// first appearance
+inline auto print_timings(const Timings &timings, std::ostream &stream)
+    -> void {
+  struct Row {
+    std::string_view name;
+    std::size_t calls{0};
+    double wall{0.0};
+    double cpu{0.0};
+  };
+
+  std::vector<Row> rows;
+  for (const auto &phase : timings.phases()) {
+    auto iterator{std::find_if(
+        rows.begin(), rows.end(),
+        [&phase](const auto &row) { return row.name == phase.name; })};
+    if (iterator == rows.end()) {
+      rows.push_back({.name = phase.name});
+      iterator = std::prev(rows.end());
+    }
+
+    iterator->calls += 1;
+    iterator->wall += phase.wall;
+    iterator->cpu += phase.cpu;
+  }
+
+  const std::chrono::duration<double, std::milli> total_wall{
+      std::chrono::steady_clock::now() - timings.origin()};
+  const auto total_cpu{
+      static_cast<double>(timings_cpu_time() - timings.origin_cpu()) / 1000.0};
+
+  const StreamFormatScope format{stream};
+  stream << std::fixed;
+  stream.precision(3);
+  stream << std::left << std::setw(16) << "phase" << std::right
+         << std::setw(8) << "calls" << std::setw(14) << "wall ms"
+         << std::setw(14) << "cpu ms" << "\n";
+  for (const auto &row : rows) {
+    stream << std::left << std::setw(16) << row.name << std::right
+           << std::setw(8) << row.calls << std::setw(14) << row.wall / 1000.0
+           << std::setw(14) << row.cpu / 1000.0 << "\n";
+  }
+
+  stream << std::left << std::setw(16) << "total" << std::right
+         << std::setw(8) << "" << std::setw(14) << total_wall.count()
+         << std::setw(14) << total_cpu << "\n";
+  stream << "peak rss: " << timings_peak_rss() / 1024 << " KiB\n";
+}
+
+// See the Trace Event Format specification, which both `chrome://tracing`
+// and Perfetto can load
+inline auto to_trace_events(const Timings &timings) -> sourcemeta::core::JSON {
+  auto events{sourcemeta::core::JSON::make_array()};
+  for (const auto &phase : timings.phases()) {
+    auto event{sourcemeta::core::JSON::make_object()};
+    event.assign("name", sourcemeta::core::JSON{std::string{phase.name}});
+    event.assign("cat", sourcemeta::core::JSON{"jsonschema"});
+    event.assign("ph", sourcemeta::core::JSON{"X"});
+    event.assign("ts", sourcemeta::core::JSON{phase.start});
+    event.assign("dur", sourcemeta::core::JSON{phase.wall});
+    event.assign("pid", sourcemeta::core::JSON{1});
+    event.assign("tid", sourcemeta::core::JSON{phase.thread});
+    auto arguments{sourcemeta::core::JSON::make_object()};
+    if (!phase.detail.empty()) {
+      arguments.assign("path", sourcemeta::core::JSON{phase.detail});
+    }
+
+    arguments.assign("cpu", sourcemeta::core::JSON{phase.cpu});
+    arguments.assign("peakRss", sourcemeta::core::JSON{
+                                    static_cast<std::size_t>(phase.peak_rss)});
+    event.assign("args", std::move(arguments));
+    events.push_back(std::move(event));
+  }
+
+  auto result{sourcemeta::core::JSON::make_object()};
+  result.assign("traceEvents", std::move(events));
+  result.assign("displayTimeUnit", sourcemeta::core::JSON{"ms"});
+  return result;
+}
+
+} // namespace sourcemeta::jsonschema
+
+#endif
@@ -16,6 +16,7 @@
 
 #include "error.h"
 #include "input.h"
+#include "timings.h"
 
 #include <algorithm>   // std::max, std::ranges::all_of
 #include <cctype>      // std::isdigit
@@ -208,6 +209,7 @@ bundle_for_evaluation(const sourcemeta::core::JSON &schema,
                       const std::filesystem::path &resolution_base,
                       const sourcemeta::core::PointerPositionTracker &positions)
     -> sourcemeta::core::JSON {
+  const TimingsScope timing{"bundle", resolution_base};
   try {
     return sourcemeta::blaze::bundle(
         schema, sourcemeta::blaze::schema_walker, resolver,
@@ -264,6 +266,7 @@ frame_for_evaluation(sourcemeta::blaze::SchemaFrame &frame,
                      const std::filesystem::path &resolution_base,
                      const sourcemeta::core::PointerPositionTracker &positions)
     -> void {
+  const TimingsScope timing{"frame", resolution_base};
   try {
     frame.analyse(bundled, sourcemeta::blaze::schema_walker, resolver, dialect,
                   default_id);
@@ -316,6 +319,7 @@ inline auto compile_for_evaluation(
     const std::filesystem::path &resolution_base,
     const sourcemeta::core::PointerPositionTracker &positions)
     -> sourcemeta::blaze::Template {
+  const TimingsScope timing{"compile", resolution_base};
   try {
     return sourcemeta::blaze::compile(
         bundled, sourcemeta::blaze::schema_walker, resolver,
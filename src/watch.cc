@@ -0,0 +1,306 @@
+#include "watch.h"
+
+#if defined(__linux__)
+#include <poll.h>        // poll, pollfd, POLLIN
+#include <sys/inotify.h> // inotify_init1, inotify_add_watch, inotify_event
+#include <unistd.h>      // read, close
+#endif
+
+#include <sourcemeta/core/io.h>
+
+#include <algorithm>    // std::any_of, std::find
+#include <cerrno>       // errno, EINTR, EAGAIN
+#include <chrono>       // std::chrono
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uintmax_t
+#include <filesystem>   // std::filesystem
+#include <map>          // std::map
+#include <memory>       // std::make_unique
+#include <optional>     // std::optional, std::nullopt
+#include <set>          // std::set
+#include <system_error> // std::system_error, std::generic_category
+#include <thread>       // std::this_thread
+#include <utility>      // std::pair, std::move
+#include <vector>       // std::vector
+
+namespace {
+
+// Editors often save a file in more than one step, so we keep collecting
+// changes until the file system has been quiet for this long
+constexpr std::chrono::milliseconds SETTLE_INTERVAL{25};
+
+#if defined(__linux__)
+auto is_watched(const std::vector<std::filesystem::path> &roots,
+                const std::set<std::filesystem::path> &files,
+                const std::filesystem::path &path) -> bool {
+  return files.contains(path) ||
+         std::any_of(roots.cbegin(), roots.cend(), [&path](const auto &root) {
+           return sourcemeta::core::is_lexically_under_path(path, root);
+         });
+}
+#endif
+
+} // namespace
+
+namespace sourcemeta::jsonschema {
+
+#if defined(__linux__)
+
+struct Watcher::Internal {
+  int descriptor{-1};
+  // Inotify only watches the direct entries of a directory, and editors
+  // commonly replace files rather than writing to them, so we always watch
+  // directories, even to only observe one of their files
+  std::map<int, std::filesystem::path> watches;
+  std::set<std::filesystem::path> directories;
+  std::vector<std::filesystem::path> roots;
+  std::set<std::filesystem::path> files;
+
+  auto watch(const std::filesystem::path &directory) -> void {
+    if (this->directories.contains(directory)) {
+      return;
+    }
+
+    const auto result{inotify_add_watch(
+        this->descriptor, directory.c_str(),
+        IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+            IN_DELETE_SELF | IN_MOVE_SELF)};
+    // The directory might be gone already or be unreadable, and there is
+    // nothing to watch in either case
+    if (result >= 0) {
+      this->watches.insert_or_assign(result, directory);
+      this->directories.insert(directory);
+    }
+  }
+
+  auto watch_recursively(const std::filesystem::path &directory,
+                         std::set<std::filesystem::path> *created) -> void {
+    this->watch(directory);
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator iterator{
+             directory,
+             std::filesystem::directory_options::skip_permission_denied,
+             error};
+         !error && iterator != std::filesystem::recursive_directory_iterator{};
+         iterator.increment(error)) {
+      if (iterator->is_directory(error)) {
+        this->watch(iterator->path());
+      } else if (created != nullptr) {
+        // Files that appear along with a new directory are changes too
+        created->insert(iterator->path());
+      }
+    }
+  }
+};
+
+Watcher::Watcher() : internal_{std::make_unique<Internal>()} {
+  this->internal_->descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (this->internal_->descriptor < 0) {
+    throw std::system_error{errno, std::generic_category(),
+                            "Could not watch the file system"};
+  }
+}
+
+Watcher::~Watcher() { close(this->internal_->descriptor); }
+
+auto Watcher::add(const std::filesystem::path &path) -> void {
+  const auto canonical{sourcemeta::core::weakly_canonical(path)};
+  if (std::filesystem::is_directory(canonical)) {
+    if (std::find(this->internal_->roots.cbegin(),
+                  this->internal_->roots.cend(),
+                  canonical) == this->internal_->roots.cend()) {
+      this->internal_->roots.push_back(canonical);
+      this->internal_->watch_recursively(canonical, nullptr);
+    }
+  } else if (this->internal_->files.insert(canonical).second) {
+    this->internal_->watch(canonical.parent_path());
+  }
+}
+
+auto Watcher::wait() -> std::optional<std::set<std::filesystem::path>> {
+  std::set<std::filesystem::path> changes;
+  bool overflow{false};
+  alignas(inotify_event) char buffer[16384];
+  while (true) {
+    pollfd target{.fd = this->internal_->descriptor, .events = POLLIN,
+                  .revents = 0};
+    const auto ready{poll(&target, 1,
+                          changes.empty() && !overflow
+                              ? -1
+                              : static_cast<int>(SETTLE_INTERVAL.count()))};
+    if (ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      throw std::system_error{errno, std::generic_category(),
+                              "Could not watch the file system"};
+    } else if (ready == 0) {
+      if (overflow) {
+        // Directories created while events were being dropped are not
+        // watched yet
+        for (const auto &root : this->internal_->roots) {
+          this->internal_->watch_recursively(root, nullptr);
+        }
+
+        return std::nullopt;
+      }
+
+      return changes;
+    }
+
+    const auto length{
+        read(this->internal_->descriptor, buffer, sizeof(buffer))};
+    if (length < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+
+      throw std::system_error{errno, std::generic_category(),
+                              "Could not watch the file system"};
+    }
+
+    for (std::size_t offset{0}; offset < static_cast<std::size_t>(length);) {
+      const auto *event{reinterpret_cast<const inotify_event *>(
+          buffer + offset)};
+      offset += sizeof(inotify_event) + event->len;
+
+      // The kernel dropped events, so we can't tell which files changed
+      if ((event->mask & IN_Q_OVERFLOW) != 0) {
+        overflow = true;
+        continue;
+      }
+
+      const auto match{this->internal_->watches.find(event->wd)};
+      if (match == this->internal_->watches.cend()) {
+        continue;
+      }
+
+      if ((event->mask & IN_IGNORED) != 0) {
+        this->internal_->directories.erase(match->second);
+        this->internal_->watches.erase(match);
+        continue;
+      }
+
+      if (event->len == 0) {
+        continue;
+      }
+
+      const auto path{match->second / event->name};
+      if (!is_watched(this->internal_->roots, this->internal_->files, path)) {
+        continue;
+      }
+
+      if ((event->mask & IN_ISDIR) == 0) {
+        changes.insert(path);
+      } else if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+        this->internal_->watch_recursively(path, &changes);
+      }
+    }
+  }
+}
+
+#else
+
+struct Watcher::Internal {
+  using State = std::pair<std::filesystem::file_time_type, std::uintmax_t>;
+  std::vector<std::filesystem::path> roots;
+  std::set<std::filesystem::path> files;
+  std::map<std::filesystem::path, State> state;
+
+  static auto stat(const std::filesystem::path &path,
+                   std::map<std::filesystem::path, State> &result) -> void {
+    std::error_code error;
+    const auto time{std::filesystem::last_write_time(path, error)};
+    if (error) {
+      return;
+    }
+
+    const auto size{std::filesystem::file_size(path, error)};
+    if (!error) {
+      result.insert_or_assign(path, State{time, size});
+    }
+  }
+
+  static auto scan(const std::filesystem::path &directory,
+                   std::map<std::filesystem::path, State> &result) -> void {
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator iterator{
+             directory,
+             std::filesystem::directory_options::skip_permission_denied,
+             error};
+         !error && iterator != std::filesystem::recursive_directory_iterator{};
+         iterator.increment(error)) {
+      if (iterator->is_regular_file(error)) {
+        stat(iterator->path(), result);
+      }
+    }
+  }
+
+  auto snapshot() const -> std::map<std::filesystem::path, State> {
+    std::map<std::filesystem::path, State> result;
+    for (const auto &root : this->roots) {
+      scan(root, result);
+    }
+
+    for (const auto &file : this->files) {
+      stat(file, result);
+    }
+
+    return result;
+  }
+};
+
+// Frequent enough for interactive use, while cheap for small trees
+constexpr std::chrono::milliseconds POLL_INTERVAL{100};
+
+Watcher::Watcher() : internal_{std::make_unique<Internal>()} {}
+
+Watcher::~Watcher() = default;
+
+auto Watcher::add(const std::filesystem::path &path) -> void {
+  const auto canonical{sourcemeta::core::weakly_canonical(path)};
+  if (std::filesystem::is_directory(canonical)) {
+    if (std::find(this->internal_->roots.cbegin(),
+                  this->internal_->roots.cend(),
+                  canonical) == this->internal_->roots.cend()) {
+      this->internal_->roots.push_back(canonical);
+      Internal::scan(canonical, this->internal_->state);
+    }
+  } else if (this->internal_->files.insert(canonical).second) {
+    Internal::stat(canonical, this->internal_->state);
+  }
+}
+
+auto Watcher::wait() -> std::optional<std::set<std::filesystem::path>> {
+  std::set<std::filesystem::path> changes;
+  while (true) {
+    std::this_thread::sleep_for(changes.empty() ? POLL_INTERVAL
+                                                : SETTLE_INTERVAL);
+    auto current{this->internal_->snapshot()};
+    bool changed{false};
+    for (const auto &[path, state] : current) {
+      const auto match{this->internal_->state.find(path)};
+      if (match == this->internal_->state.cend() || match->second != state) {
+        changes.insert(path);
+        changed = true;
+      }
+    }
+
+    for (const auto &entry : this->internal_->state) {
+      if (!current.contains(entry.first)) {
+        changes.insert(entry.first);
+        changed = true;
+      }
+    }
+
+    this->internal_->state = std::move(current);
+    if (!changed && !changes.empty()) {
+      return changes;
+    }
+  }
+}
+
+#endif
+
+} // namespace sourcemeta::jsonschema
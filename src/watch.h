@@ -0,0 +1,235 @@
+#ifndef SOURCEMETA_JSONSCHEMA_CLI_WATCH_H_
+#define SOURCEMETA_JSONSCHEMA_CLI_WATCH_H_
+
+#include <sourcemeta/core/io.h>
+
+#include <algorithm>  // std::any_of
+#include <atomic>     // std::atomic
+#include <filesystem> // std::filesystem
+#include <map>        // std::map
+#include <memory>     // std::unique_ptr
+#include <mutex>      // std::mutex, std::lock_guard
+#include <optional>   // std::optional
+#include <set>        // std::set
+#include <utility>    // std::move
+
+namespace sourcemeta::jsonschema {
+
+// Block until files change. This is implemented per platform in `watch.cc`,
+// using inotify on Linux and polling file metadata elsewhere
+class Watcher {
+public:
+  Watcher();
+  ~Watcher();
+
+  Watcher(const Watcher &) = delete;
+  Watcher(Watcher &&) = delete;
+  auto operator=(const Watcher &) -> Watcher & = delete;
+  auto operator=(Watcher &&) -> Watcher & = delete;
+
+  // Watch a file, which does not need to exist yet, or every file in a
+  // directory recursively. Adding the same path more than once is a no-op
+  auto add(const std::filesystem::path &path) -> void;
+
+  // Block until a watched file is written, created, renamed or deleted, and
+  // return every watched file that changed until the file system settled.
+  // Returns nothing if there were more changes than the platform could keep
+  // track of, in which case any watched file might have changed
+  auto wait() -> std::optional<std::set<std::filesystem::path>>;
+
+private:
+  struct Internal;
+  std::unique_ptr<Internal> internal_;
+};
+
+// The process-wide state of `--watch/-W`, which runs a command again in the
+// same process after every change, so that configuration files, resolvers
+// and compiled schemas remain resident. Commands consult it to only process
+// the files that the last changes affected. All paths are canonical
+class Watch {
+public:
+  static auto instance() -> Watch & {
+    static Watch watch;
+    return watch;
+  }
+
+  auto enable() -> void {
+    this->enabled_.store(true, std::memory_order_release);
+  }
+
+  [[nodiscard]] auto enabled() const noexcept -> bool {
+    return this->enabled_.load(std::memory_order_acquire);
+  }
+
+  // Whether the current run only has to process the affected files, as
+  // opposed to every file, like the first run does
+  [[nodiscard]] auto incremental() const noexcept -> bool {
+    return this->incremental_.load(std::memory_order_acquire);
+  }
+
+  // Whether the outcome of processing the given file might differ from the
+  // previous run, given the file or any file it depends on changed
+  [[nodiscard]] auto affected(const std::filesystem::path &path) const
+      -> bool {
+    if (!this->incremental()) {
+      return true;
+    }
+
+    const auto canonical{sourcemeta::core::weakly_canonical(path)};
+    std::lock_guard<std::mutex> lock{this->mutex_};
+    return this->affected_.contains(canonical);
+  }
+
+  // Changing the given file invalidates every result of the command. For
+  // example, a configuration file or a custom lint rule
+  auto depend_globally(const std::filesystem::path &path) -> void {
+    if (!this->enabled()) {
+      return;
+    }
+
+    const auto canonical{sourcemeta::core::weakly_canonical(path)};
+    std::lock_guard<std::mutex> lock{this->mutex_};
+    this->globals_.insert(canonical);
+  }
+
+  // Replace the files that the given file was found to depend on
+  auto record(const std::filesystem::path &dependent,
+              std::set<std::filesystem::path> &&dependencies) -> void {
+    std::lock_guard<std::mutex> lock{this->mutex_};
+    this->dependencies_.insert_or_assign(dependent, std::move(dependencies));
+  }
+
+  // Every file that commands depend on, beyond their own inputs
+  [[nodiscard]] auto paths() const -> std::set<std::filesystem::path> {
+    std::lock_guard<std::mutex> lock{this->mutex_};
+    std::set<std::filesystem::path> result{this->globals_};
+    for (const auto &entry : this->dependencies_) {
+      result.insert(entry.second.cbegin(), entry.second.cend());
+    }
+
+    return result;
+  }
+
+  // Determine the files that the next run has to process given a set of
+  // changes. The dependencies of a file are recorded while processing it,
+  // and that involves resolving every reference it transitively reaches,
+  // so we don't need to walk the dependency graph here. Returns false if
+  // the next run has to process every file
+  auto invalidate(const std::set<std::filesystem::path> &changes) -> bool {
+    std::lock_guard<std::mutex> lock{this->mutex_};
+    if (std::any_of(changes.cbegin(), changes.cend(),
+                    [this](const auto &path) {
+                      return this->globals_.contains(path);
+                    })) {
+      this->reset_unlocked();
+      return false;
+    }
+
+    this->affected_ = changes;
+    for (const auto &[dependent, dependencies] : this->dependencies_) {
+      if (std::any_of(changes.cbegin(), changes.cend(),
+                      [&dependencies](const auto &path) {
+                        return dependencies.contains(path);
+                      })) {
+        this->affected_.insert(dependent);
+      }
+    }
+
+    this->incremental_.store(true, std::memory_order_release);
+    return true;
+  }
+
+  // Forget everything, so that the next run processes every file
+  auto reset() -> void {
+    std::lock_guard<std::mutex> lock{this->mutex_};
+    this->reset_unlocked();
+  }
+
+private:
+  Watch() = default;
+
+  auto reset_unlocked() -> void {
+    this->incremental_.store(false, std::memory_order_release);
+    this->affected_.clear();
+    this->globals_.clear();
+    this->dependencies_.clear();
+  }
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<bool> incremental_{false};
+  mutable std::mutex mutex_;
+  std::set<std::filesystem::path> affected_;
+  std::set<std::filesystem::path> globals_;
+  std::map<std::filesystem::path, std::set<std::filesystem::path>>
+      dependencies_;
+};
+
+// Attribute the files that resolving schemas reads on this thread to the
+// given file, so that changing any of them causes the file to be processed
+// again. Scopes nest, and a scope without a file only collects dependencies
+// to hand them to its enclosing scope
+class WatchScope {
+public:
+  WatchScope() : active_{Watch::instance().enabled()} {
+    if (this->active_) {
+      this->previous_ = current();
+      current() = this;
+    }
+  }
+
+  WatchScope(const std::filesystem::path &path) : WatchScope{} {
+    if (this->active_) {
+      this->path_ = sourcemeta::core::weakly_canonical(path);
+    }
+  }
+
+  ~WatchScope() {
+    if (!this->active_) {
+      return;
+    }
+
+    current() = this->previous_;
+    if (this->previous_ != nullptr) {
+      this->previous_->dependencies_.insert(this->dependencies_.cbegin(),
+                                            this->dependencies_.cend());
+    }
+
+    if (!this->path_.empty()) {
+      Watch::instance().record(this->path_, std::move(this->dependencies_));
+    }
+  }
+
+  WatchScope(const WatchScope &) = delete;
+  WatchScope(WatchScope &&) = delete;
+  auto operator=(const WatchScope &) -> WatchScope & = delete;
+  auto operator=(WatchScope &&) -> WatchScope & = delete;
+
+  // Record that whatever the current thread is processing depends on the
+  // given file, if anything
+  static auto depend(const std::filesystem::path &path) -> void {
+    auto *const scope{current()};
+    if (scope != nullptr) {
+      scope->dependencies_.insert(sourcemeta::core::weakly_canonical(path));
+    }
+  }
+
+  [[nodiscard]] auto dependencies() const noexcept
+      -> const std::set<std::filesystem::path> & {
+    return this->dependencies_;
+  }
+
+private:
+  static auto current() -> WatchScope *& {
+    thread_local WatchScope *scope{nullptr};
+    return scope;
+  }
+
+  bool active_;
+  WatchScope *previous_{nullptr};
+  std::filesystem::path path_;
+  std::set<std::filesystem::path> dependencies_;
+};
+
+} // namespace sourcemeta::jsonschema
+
+#endif
@@ -104,6 +104,7 @@ test_completion "jsonschema " "codegen" "Command completion includes codegen"
 test_completion "jsonschema " "install" "Command completion includes install"
 test_completion "jsonschema " "upgrade" "Command completion includes upgrade"
 test_completion "jsonschema " "rdf" "Command completion includes rdf"
+test_completion "jsonschema " "openapi" "Command completion includes openapi"
 test_completion "jsonschema " "version" "Command completion includes version"
 test_completion "jsonschema " "help" "Command completion includes help"
 
@@ -111,11 +112,17 @@ test_completion "jsonschema validate --" "--verbose" "Validate includes global o
 test_completion "jsonschema validate --" "--benchmark" "Validate includes --benchmark"
 test_completion "jsonschema validate --" "--trace" "Validate includes --trace"
 test_completion "jsonschema validate --" "--fast" "Validate includes --fast"
+test_completion "jsonschema validate --" "--watch" "Validate includes --watch"
+test_completion "jsonschema validate --" "--shard" "Validate includes --shard"
+test_completion "jsonschema validate --" "--ndjson" "Validate includes --ndjson"
 
 test_completion "jsonschema lint --" "--fix" "Lint includes --fix"
 test_completion "jsonschema lint --" "--list" "Lint includes --list"
 test_completion "jsonschema lint --" "--rule" "Lint includes --rule"
 test_completion "jsonschema lint --" "--top-level-rule" "Lint includes --top-level-rule"
+test_completion "jsonschema lint --" "--cache" "Lint includes --cache"
+test_completion "jsonschema lint --" "--watch" "Lint includes --watch"
+test_completion "jsonschema lint --" "--shard" "Lint includes --shard"
 
 test_completion "jsonschema bundle --" "--without-id" "Bundle includes --without-id"
 
@@ -123,6 +130,8 @@ test_completion "jsonschema compile --" "--minify" "Compile includes --minify"
 
 test_completion "jsonschema fmt --" "--check" "Fmt includes --check"
 test_completion "jsonschema fmt --" "--keep-ordering" "Fmt includes --keep-ordering"
+test_completion "jsonschema fmt --" "--cache" "Fmt includes --cache"
+test_completion "jsonschema fmt --" "--shard" "Fmt includes --shard"
 
 test_completion "jsonschema codegen --" "--name" "Codegen includes --name"
 test_completion "jsonschema codegen --" "--target" "Codegen includes --target"
@@ -139,6 +148,9 @@ test_completion "jsonschema rdf --" "--fast" "Rdf includes --fast"
 test_completion "jsonschema rdf --" "--format-assertion" "Rdf includes --format-assertion"
 test_completion "jsonschema rdf --" "--verbose" "Rdf includes global option --verbose"
 
+test_completion "jsonschema openapi --" "--fast" "OpenAPI includes --fast"
+test_completion "jsonschema openapi --" "--jobs" "OpenAPI includes --jobs"
+
 test_completion "jsonschema validate --" "--header" "Validate includes global option --header"
 test_no_completion "jsonschema validate --header " "After --header no completion is offered"
 test_no_completion "jsonschema validate -H " "After -H no completion is offered"
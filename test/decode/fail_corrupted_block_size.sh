@@ -0,0 +1,33 @@
+#!/bin/sh
+
+set -o errexit
+set -o nounset
+
+TMP="$(mktemp -d)"
+clean() { rm -rf "$TMP"; }
+trap clean EXIT
+
+cat << 'EOF' > "$TMP/document.jsonl"
+{ "count": 1 }
+{ "count": 2 }
+EOF
+
+"$1" encode "$TMP/document.jsonl" "$TMP/output.binpack" 2> /dev/null
+
+# The 8-byte payload size of the first block follows the 5-byte container
+# header and the 4-byte record count of the block. Claim the largest possible
+# payload, which must be rejected rather than allocated
+printf '\377\377\377\377\377\377\377\377' \
+  | dd of="$TMP/output.binpack" bs=1 seek=9 conv=notrunc 2> /dev/null
+
+"$1" decode "$TMP/output.binpack" "$TMP/result.jsonl" \
+  2> "$TMP/output.txt" && EXIT_CODE="$?" || EXIT_CODE="$?"
+# Other input error
+test "$EXIT_CODE" = "6"
+
+cat << 'EOF' > "$TMP/expected.txt"
+error: The JSON BinPack container index is corrupted
+EOF
+
+head -n 1 "$TMP/output.txt" > "$TMP/error.txt"
+diff "$TMP/error.txt" "$TMP/expected.txt"
@@ -0,0 +1,75 @@
+#!/bin/sh
+
+set -o errexit
+set -o nounset
+
+TMP="$(mktemp -d)"
+clean() { rm -rf "$TMP"; }
+trap clean EXIT
+
+cat << 'EOF' > "$TMP/schema.json"
+{
+  "id": "https://example.com",
+  "$schema": "http://json-schema.org/draft-04/schema#",
+  "type": "string"
+}
+EOF
+
+# A suite large enough to spread its test cases across every thread. See
+# `LARGE_SUITE_TEST_CASES`. Every tenth case is expected to fail validation
+# and a single one in the middle fails unexpectedly
+mkdir "$TMP/tests"
+{
+  printf '{\n  "target": "https://example.com",\n  "tests": [\n'
+  INDEX=1
+  while [ "$INDEX" -le 1100 ]
+  do
+    if [ "$INDEX" = "777" ]
+    then
+      printf '    { "description": "Case %s", "valid": true, "data": %s }' \
+        "$INDEX" "$INDEX"
+    elif [ "$((INDEX % 10))" = "0" ]
+    then
+      printf '    { "description": "Case %s", "valid": false, "data": %s }' \
+        "$INDEX" "$INDEX"
+    else
+      printf '    { "description": "Case %s", "valid": true, "data": "%s" }' \
+        "$INDEX" "$INDEX"
+    fi
+
+    if [ "$INDEX" != "1100" ]
+    then
+      printf ',\n'
+    fi
+
+    INDEX=$((INDEX + 1))
+  done
+  printf '\n  ]\n}\n'
+} > "$TMP/tests/suite.json"
+
+# Serially and in parallel, the test cases must be reported in the same order
+for JOBS in 1 2
+do
+  "$1" test "$TMP/tests" --resolve "$TMP/schema.json" --verbose --jobs "$JOBS" \
+    > "$TMP/text_$JOBS.txt" \
+    && EXIT_CODE="$?" || EXIT_CODE="$?"
+  # Test assertion failure
+  test "$EXIT_CODE" = "2"
+
+  "$1" test "$TMP/tests" --resolve "$TMP/schema.json" --json --jobs "$JOBS" \
+    > "$TMP/ctrf_$JOBS.json" \
+    && EXIT_CODE="$?" || EXIT_CODE="$?"
+  # Test assertion failure
+  test "$EXIT_CODE" = "2"
+
+  # Timings and threads are expected to differ between runs
+  grep -v -e '"duration":' -e '"start":' -e '"stop":' -e '"threadId":' \
+    "$TMP/ctrf_$JOBS.json" > "$TMP/ctrf_$JOBS.txt"
+done
+
+test "$(grep -c '/1100 PASS Case ' "$TMP/text_1.txt")" = "1099"
+grep -q '^  777/1100 FAIL Case 777$' "$TMP/text_1.txt"
+test "$(grep -c '"status": "passed"' "$TMP/ctrf_1.txt")" = "1099"
+
+diff "$TMP/text_1.txt" "$TMP/text_2.txt"
+diff "$TMP/ctrf_1.txt" "$TMP/ctrf_2.txt"
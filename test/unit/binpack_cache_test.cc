@@ -0,0 +1,162 @@
+#include <sourcemeta/core/test.h>
+
+#include <sourcemeta/jsonbinpack/runtime_encoder_cache.h>
+
+#include <cstddef> // std::byte
+#include <string>  // std::string
+#include <vector>  // std::vector
+
+using Cache = sourcemeta::jsonbinpack::Cache;
+
+static auto append(std::vector<std::byte> &buffer, const std::string &value)
+    -> void {
+  for (const auto character : value) {
+    buffer.push_back(static_cast<std::byte>(character));
+  }
+}
+
+TEST(collision_buffer_standalone) {
+  std::vector<std::byte> buffer;
+  Cache cache{buffer};
+  // Every string of the same length now collides
+  cache.reduce_hash(0);
+  append(buffer, "xx");
+  cache.record("foo", buffer.size(), Cache::Type::Standalone);
+  append(buffer, "foo");
+
+  const auto same{cache.find("foo", Cache::Type::Standalone)};
+  EXPECT_TRUE(same.has_value());
+  EXPECT_EQ(same.value(), 2);
+  EXPECT_FALSE(cache.find("bar", Cache::Type::Standalone).has_value());
+}
+
+TEST(collision_buffer_both_recorded) {
+  std::vector<std::byte> buffer;
+  Cache cache{buffer};
+  cache.reduce_hash(0);
+  cache.record("foo", buffer.size(), Cache::Type::Standalone);
+  append(buffer, "foo");
+  cache.record("bar", buffer.size(), Cache::Type::Standalone);
+  append(buffer, "bar");
+
+  const auto foo{cache.find("foo", Cache::Type::Standalone)};
+  const auto bar{cache.find("bar", Cache::Type::Standalone)};
+  EXPECT_TRUE(foo.has_value());
+  EXPECT_TRUE(bar.has_value());
+  EXPECT_EQ(foo.value(), 0);
+  EXPECT_EQ(bar.value(), 3);
+  EXPECT_FALSE(cache.find("baz", Cache::Type::Standalone).has_value());
+}
+
+TEST(collision_buffer_prefix_length) {
+  std::vector<std::byte> buffer;
+  Cache cache{buffer};
+  cache.reduce_hash(0);
+  // The string is recorded at its length, which is the varint 4
+  cache.record("foo", buffer.size(), Cache::Type::PrefixLengthVarintPlusOne);
+  buffer.push_back(std::byte{4});
+  append(buffer, "foo");
+
+  const auto same{cache.find("foo", Cache::Type::PrefixLengthVarintPlusOne)};
+  EXPECT_TRUE(same.has_value());
+  EXPECT_EQ(same.value(), 0);
+  EXPECT_FALSE(
+      cache.find("bar", Cache::Type::PrefixLengthVarintPlusOne).has_value());
+}
+
+TEST(collision_buffer_bumped) {
+  std::vector<std::byte> buffer;
+  Cache cache{buffer};
+  cache.reduce_hash(0);
+  cache.record("foo", buffer.size(), Cache::Type::PrefixLengthVarintPlusOne);
+  buffer.push_back(std::byte{4});
+  append(buffer, "foo");
+
+  // A back-reference was written, so the bytes there are not the string
+  cache.record("foo", buffer.size(), Cache::Type::PrefixLengthVarintPlusOne);
+  buffer.push_back(std::byte{0});
+  buffer.push_back(std::byte{4});
+
+  const auto same{cache.find("foo", Cache::Type::PrefixLengthVarintPlusOne)};
+  EXPECT_TRUE(same.has_value());
+  EXPECT_EQ(same.value(), 4);
+  EXPECT_FALSE(
+      cache.find("bar", Cache::Type::PrefixLengthVarintPlusOne).has_value());
+}
+
+TEST(collision_stream) {
+  Cache cache;
+  cache.reduce_hash(0);
+  cache.record("foo", 5, Cache::Type::Standalone);
+
+  const auto same{cache.find("foo", Cache::Type::Standalone)};
+  EXPECT_TRUE(same.has_value());
+  EXPECT_EQ(same.value(), 5);
+  EXPECT_FALSE(cache.find("bar", Cache::Type::Standalone).has_value());
+}
+
+TEST(collision_remove_oldest) {
+  std::vector<std::byte> buffer;
+  Cache cache{buffer};
+  cache.reduce_hash(0);
+  cache.record("foo", buffer.size(), Cache::Type::Standalone);
+  append(buffer, "foo");
+  cache.record("bar", buffer.size(), Cache::Type::Standalone);
+  append(buffer, "bar");
+
+  cache.remove_oldest();
+  EXPECT_FALSE(cache.find("foo", Cache::Type::Standalone).has_value());
+  const auto bar{cache.find("bar", Cache::Type::Standalone)};
+  EXPECT_TRUE(bar.has_value());
+  EXPECT_EQ(bar.value(), 3);
+}
+
+TEST(collision_grow) {
+  std::vector<std::byte> buffer;
+  Cache cache{buffer};
+  cache.reduce_hash(0);
+  // Enough strings to grow the table past its initial size
+  for (auto index = 0; index < 100; index++) {
+    const auto value{"value-" + std::to_string(index)};
+    cache.record(value, buffer.size(), Cache::Type::Standalone);
+    append(buffer, value);
+  }
+
+  std::size_t offset{0};
+  for (auto index = 0; index < 100; index++) {
+    const auto value{"value-" + std::to_string(index)};
+    const auto result{cache.find(value, Cache::Type::Standalone)};
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), offset);
+    offset += value.size();
+  }
+
+  EXPECT_FALSE(cache.find("value-100", Cache::Type::Standalone).has_value());
+}
+
+TEST(stream_byte_size_evicts_oldest) {
+  Cache cache;
+  // Three strings of 8 MiB go over the 20 MiB that the cache copies at most
+  const std::string first(8388608, 'a');
+  const std::string second(8388608, 'b');
+  const std::string third(8388608, 'c');
+  cache.record(first, 0, Cache::Type::Standalone);
+  cache.record(second, 1, Cache::Type::Standalone);
+  EXPECT_TRUE(cache.find(first, Cache::Type::Standalone).has_value());
+  cache.record(third, 2, Cache::Type::Standalone);
+
+  EXPECT_FALSE(cache.find(first, Cache::Type::Standalone).has_value());
+  const auto second_offset{cache.find(second, Cache::Type::Standalone)};
+  const auto third_offset{cache.find(third, Cache::Type::Standalone)};
+  EXPECT_TRUE(second_offset.has_value());
+  EXPECT_TRUE(third_offset.has_value());
+  EXPECT_EQ(second_offset.value(), 1);
+  EXPECT_EQ(third_offset.value(), 2);
+}
+
+TEST(stream_byte_size_too_large) {
+  Cache cache;
+  const std::string value(20971520, 'a');
+  cache.record(value, 0, Cache::Type::Standalone);
+  EXPECT_FALSE(cache.find(value, Cache::Type::Standalone).has_value());
+}
@@ -0,0 +1,123 @@
+#include <sourcemeta/blaze/compiler.h>
+#include <sourcemeta/blaze/evaluator.h>
+#include <sourcemeta/blaze/foundation.h>
+#include <sourcemeta/core/json.h>
+#include <sourcemeta/core/test.h>
+
+#include <cstddef> // std::size_t
+#include <utility> // std::move
+
+using Evaluator = sourcemeta::blaze::Evaluator;
+using JSON = sourcemeta::core::JSON;
+using Template = sourcemeta::blaze::Template;
+
+// Every branch of the disjunction descends into both operands before the
+// operator tells it apart, so without memoisation evaluating a node takes
+// time exponential on its depth
+static auto compile_expression() -> Template {
+  return sourcemeta::blaze::compile(
+      sourcemeta::core::parse_json(R"JSON({
+        "$schema": "https://json-schema.org/draft/2020-12/schema",
+        "$ref": "#/$defs/Expression",
+        "$defs": {
+          "Expression": {
+            "anyOf": [
+              { "$ref": "#/$defs/Sum" },
+              { "$ref": "#/$defs/Product" },
+              { "$ref": "#/$defs/Literal" }
+            ]
+          },
+          "Sum": {
+            "type": "array",
+            "prefixItems": [
+              { "$ref": "#/$defs/Expression" },
+              { "$ref": "#/$defs/Expression" },
+              { "const": "+" }
+            ],
+            "items": false,
+            "minItems": 3
+          },
+          "Product": {
+            "type": "array",
+            "prefixItems": [
+              { "$ref": "#/$defs/Expression" },
+              { "$ref": "#/$defs/Expression" },
+              { "const": "*" }
+            ],
+            "items": false,
+            "minItems": 3
+          },
+          "Literal": { "type": "integer" }
+        }
+      })JSON"),
+      sourcemeta::blaze::schema_walker, sourcemeta::blaze::schema_resolver,
+      sourcemeta::blaze::default_schema_compiler,
+      sourcemeta::blaze::Mode::FastValidation);
+}
+
+// A chain of products down the first operand, ending on the given leaf
+static auto expression_chain(const std::size_t depth, const JSON &leaf)
+    -> JSON {
+  auto result{leaf};
+  for (std::size_t index = 0; index < depth; index++) {
+    auto node{JSON::make_array()};
+    node.push_back(std::move(result));
+    node.push_back(JSON{2});
+    node.push_back(JSON{"*"});
+    result = std::move(node);
+  }
+
+  return result;
+}
+
+TEST(memoize_matches_without) {
+  const auto schema_template{compile_expression()};
+  Evaluator plain;
+  Evaluator memoized;
+  memoized.memoize(true);
+
+  const auto check{[&](const char *input, const bool expected) {
+    const auto instance{sourcemeta::core::parse_json(input)};
+    EXPECT_EQ(plain.validate(schema_template, instance), expected);
+    EXPECT_EQ(memoized.validate(schema_template, instance), expected);
+  }};
+
+  check(R"JSON(1)JSON", true);
+  check(R"JSON([[1, 2, "+"], [[3, 4, "*"], 5, "+"], "*"])JSON", true);
+  check(R"JSON([[1, 2, "+"], [[3, 4, "/"], 5, "+"], "*"])JSON", false);
+  check(R"JSON([[1, 2, "+"], [[3, 4.5, "*"], 5, "+"], "*"])JSON", false);
+  check(R"JSON([[1, 2, "+"], [[3, 4], 5, "+"], "*"])JSON", false);
+  check(R"JSON([[1, 2, "+"], [[3, 4, "*", 6], 5, "+"], "*"])JSON", false);
+  check(R"JSON("+")JSON", false);
+}
+
+TEST(memoize_tells_colliding_instances_apart) {
+  const auto schema_template{compile_expression()};
+  Evaluator evaluator;
+  evaluator.memoize(true);
+
+  // Both operands hash the same, but only the first one is valid
+  const auto instance{sourcemeta::core::parse_json(
+      R"JSON([[1, 2, "+"], [1, 2, "-"], "*"])JSON")};
+  EXPECT_EQ(instance.at(0).fast_hash(), instance.at(1).fast_hash());
+  EXPECT_FALSE(evaluator.validate(schema_template, instance));
+
+  // Nor does the outcome leak from one evaluation to the next
+  const auto operand{sourcemeta::core::parse_json(R"JSON([1, 2, "-"])JSON")};
+  EXPECT_FALSE(evaluator.validate(schema_template, operand));
+  const auto other{sourcemeta::core::parse_json(R"JSON([1, 2, "+"])JSON")};
+  EXPECT_TRUE(evaluator.validate(schema_template, other));
+  EXPECT_FALSE(evaluator.validate(schema_template, operand));
+}
+
+TEST(memoize_deep_expression) {
+  const auto schema_template{compile_expression()};
+  Evaluator evaluator;
+  evaluator.memoize(true);
+
+  // Without memoisation, this would take in the order of 2^64 jumps
+  EXPECT_TRUE(evaluator.validate(schema_template,
+                                 expression_chain(64, JSON{1})));
+  EXPECT_FALSE(evaluator.validate(schema_template,
+                                  expression_chain(64, JSON{"1"})));
+}
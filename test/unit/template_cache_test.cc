@@ -0,0 +1,139 @@
+#include <sourcemeta/blaze/compiler.h>
+#include <sourcemeta/blaze/evaluator.h>
+#include <sourcemeta/blaze/foundation.h>
+#include <sourcemeta/blaze/test.h>
+#include <sourcemeta/core/json.h>
+#include <sourcemeta/core/jsonpointer.h>
+#include <sourcemeta/core/options.h>
+#include <sourcemeta/core/test.h>
+
+#include "resolver.h"
+#include "template_cache.h"
+
+#include <cstddef>    // std::size_t
+#include <filesystem> // std::filesystem
+#include <functional> // std::ref, std::function
+#include <memory>     // std::make_shared
+#include <optional>   // std::nullopt
+#include <stdexcept>  // std::runtime_error
+#include <string>     // std::string
+#include <utility>    // std::pair
+#include <vector>     // std::vector
+
+using Mode = sourcemeta::blaze::Mode;
+using Template = sourcemeta::blaze::Template;
+using TestSuite = sourcemeta::blaze::TestSuite;
+
+static constexpr auto TARGET_SCHEMA{
+    "https://json-schema.org/draft/2020-12/schema"};
+static constexpr auto TARGET_META_CORE{
+    "https://json-schema.org/draft/2020-12/meta/core"};
+
+static auto parse_suite(const std::string &input,
+                        const TestSuite::TemplateProvider &provider)
+    -> TestSuite {
+  sourcemeta::core::PointerPositionTracker tracker;
+  sourcemeta::core::JSON document{nullptr};
+  sourcemeta::core::parse_json(input, document, std::ref(tracker));
+  return TestSuite::parse(document, tracker, std::filesystem::current_path(),
+                          sourcemeta::blaze::schema_resolver,
+                          sourcemeta::blaze::schema_walker,
+                          sourcemeta::blaze::default_schema_compiler, "", "",
+                          std::nullopt, provider);
+}
+
+TEST(suite_provider_per_target_and_mode) {
+  std::vector<std::pair<std::string, Mode>> calls;
+  auto suite{parse_suite(
+      R"JSON({
+        "target": [
+          "https://json-schema.org/draft/2020-12/schema",
+          "https://json-schema.org/draft/2020-12/meta/core"
+        ],
+        "tests": [ { "data": {}, "valid": true } ]
+      })JSON",
+      [&calls](const auto &target, const Mode mode, const auto &,
+               const std::function<Template()> &compile) {
+        calls.emplace_back(target, mode);
+        return std::make_shared<const Template>(compile());
+      })};
+
+  // Every target is compiled for fast validation upfront
+  EXPECT_EQ(calls.size(), 2);
+  EXPECT_EQ(calls.at(0).first, TARGET_SCHEMA);
+  EXPECT_TRUE(calls.at(0).second == Mode::FastValidation);
+  EXPECT_EQ(calls.at(1).first, TARGET_META_CORE);
+  EXPECT_TRUE(calls.at(1).second == Mode::FastValidation);
+
+  // And for exhaustive validation only once asked for it
+  static_cast<void>(suite.exhaustive(1));
+  static_cast<void>(suite.exhaustive(1));
+  EXPECT_EQ(calls.size(), 3);
+  EXPECT_EQ(calls.at(2).first, TARGET_META_CORE);
+  EXPECT_TRUE(calls.at(2).second == Mode::Exhaustive);
+}
+
+TEST(cache_shared_target_compiles_once) {
+  const sourcemeta::core::Options options;
+  const sourcemeta::jsonschema::CustomResolver resolver{options, std::nullopt,
+                                                        false, ""};
+  sourcemeta::jsonschema::TemplateCache cache;
+  const auto provider{cache.provider(resolver)};
+  std::size_t compiled{0};
+  const TestSuite::TemplateProvider counting{
+      [&provider, &compiled](const auto &target, const Mode mode,
+                             const auto &tweaks,
+                             const std::function<Template()> &compile) {
+        return provider(target, mode, tweaks, [&compiled, &compile]() {
+          compiled += 1;
+          return compile();
+        });
+      }};
+
+  constexpr auto input{R"JSON({
+    "target": "https://json-schema.org/draft/2020-12/schema",
+    "tests": [ { "data": {}, "valid": true } ]
+  })JSON"};
+  auto first{parse_suite(input, counting)};
+  auto second{parse_suite(input, counting)};
+  EXPECT_EQ(compiled, 1);
+  EXPECT_EQ(&first.fast(0), &second.fast(0));
+
+  // Each mode is cached on its own
+  EXPECT_EQ(&first.exhaustive(0), &second.exhaustive(0));
+  EXPECT_EQ(compiled, 2);
+  EXPECT_NE(&first.fast(0), &first.exhaustive(0));
+}
+
+TEST(cache_failed_compile_is_retried) {
+  const sourcemeta::core::Options options;
+  const sourcemeta::jsonschema::CustomResolver resolver{options, std::nullopt,
+                                                        false, ""};
+  sourcemeta::jsonschema::TemplateCache cache;
+  const auto provider{cache.provider(resolver)};
+
+  bool thrown{false};
+  try {
+    provider(TARGET_SCHEMA, Mode::FastValidation, std::nullopt,
+             []() -> Template { throw std::runtime_error{"Failed"}; });
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+
+  EXPECT_TRUE(thrown);
+
+  std::size_t compiled{0};
+  const auto compile{[&compiled]() {
+    compiled += 1;
+    return Template{};
+  }};
+
+  const auto result{
+      provider(TARGET_SCHEMA, Mode::FastValidation, std::nullopt, compile)};
+  EXPECT_TRUE(result != nullptr);
+  EXPECT_EQ(compiled, 1);
+  EXPECT_EQ(
+      provider(TARGET_SCHEMA, Mode::FastValidation, std::nullopt, compile),
+      result);
+  EXPECT_EQ(compiled, 1);
+}
@@ -0,0 +1,184 @@
+#include <sourcemeta/core/io.h>
+#include <sourcemeta/core/test.h>
+
+#include "watch.h"
+
+#include <cstddef>    // std::size_t
+#include <filesystem> // std::filesystem
+#include <fstream>    // std::ifstream, std::ofstream
+#include <set>        // std::set
+#include <string>     // std::to_string
+
+using Watch = sourcemeta::jsonschema::Watch;
+using WatchScope = sourcemeta::jsonschema::WatchScope;
+using Watcher = sourcemeta::jsonschema::Watcher;
+
+static auto path(const char *name) -> std::filesystem::path {
+  return sourcemeta::core::weakly_canonical(
+      std::filesystem::temp_directory_path() / "jsonschema_watch" / name);
+}
+
+// The state is process-wide, so every test starts from scratch
+static auto watch() -> Watch & {
+  auto &result{Watch::instance()};
+  result.enable();
+  result.reset();
+  return result;
+}
+
+TEST(first_run_processes_everything) {
+  const auto &state{watch()};
+  EXPECT_TRUE(state.enabled());
+  EXPECT_FALSE(state.incremental());
+  EXPECT_TRUE(state.affected(path("foo.json")));
+  EXPECT_TRUE(state.paths().empty());
+}
+
+TEST(scope_records_dependencies) {
+  auto &state{watch()};
+  {
+    const WatchScope scope{path("foo.json")};
+    WatchScope::depend(path("bar.json"));
+    WatchScope::depend(path("baz.json"));
+    EXPECT_EQ(scope.dependencies().size(), 2);
+  }
+
+  const std::set<std::filesystem::path> expected{path("bar.json"),
+                                                 path("baz.json")};
+  EXPECT_TRUE(state.paths() == expected);
+}
+
+TEST(depend_outside_scope) {
+  auto &state{watch()};
+  WatchScope::depend(path("bar.json"));
+  EXPECT_TRUE(state.paths().empty());
+}
+
+TEST(nested_scope_hands_dependencies_to_parent) {
+  auto &state{watch()};
+  {
+    const WatchScope outer{path("foo.json")};
+    {
+      const WatchScope inner;
+      WatchScope::depend(path("bar.json"));
+    }
+
+    EXPECT_EQ(outer.dependencies().size(), 1);
+    EXPECT_TRUE(outer.dependencies().contains(path("bar.json")));
+  }
+
+  EXPECT_TRUE(state.invalidate({path("bar.json")}));
+  EXPECT_TRUE(state.affected(path("foo.json")));
+}
+
+TEST(invalidate_dependency) {
+  auto &state{watch()};
+  {
+    const WatchScope scope{path("foo.json")};
+    WatchScope::depend(path("bar.json"));
+  }
+
+  {
+    const WatchScope scope{path("qux.json")};
+    WatchScope::depend(path("baz.json"));
+  }
+
+  EXPECT_TRUE(state.invalidate({path("bar.json")}));
+  EXPECT_TRUE(state.incremental());
+  EXPECT_TRUE(state.affected(path("foo.json")));
+  EXPECT_TRUE(state.affected(path("bar.json")));
+  EXPECT_FALSE(state.affected(path("qux.json")));
+  EXPECT_FALSE(state.affected(path("baz.json")));
+}
+
+TEST(invalidate_file_itself) {
+  auto &state{watch()};
+  {
+    const WatchScope scope{path("foo.json")};
+    WatchScope::depend(path("bar.json"));
+  }
+
+  EXPECT_TRUE(state.invalidate({path("foo.json")}));
+  EXPECT_TRUE(state.affected(path("foo.json")));
+  EXPECT_FALSE(state.affected(path("bar.json")));
+}
+
+TEST(invalidate_unrelated) {
+  auto &state{watch()};
+  {
+    const WatchScope scope{path("foo.json")};
+    WatchScope::depend(path("bar.json"));
+  }
+
+  EXPECT_TRUE(state.invalidate({path("baz.json")}));
+  EXPECT_FALSE(state.affected(path("foo.json")));
+  // The dependencies stay around for the changes that follow
+  EXPECT_TRUE(state.invalidate({path("bar.json")}));
+  EXPECT_TRUE(state.affected(path("foo.json")));
+}
+
+TEST(record_replaces_dependencies) {
+  auto &state{watch()};
+  state.record(path("foo.json"), {path("bar.json")});
+  state.record(path("foo.json"), {path("baz.json")});
+
+  EXPECT_TRUE(state.invalidate({path("bar.json")}));
+  EXPECT_FALSE(state.affected(path("foo.json")));
+  EXPECT_TRUE(state.invalidate({path("baz.json")}));
+  EXPECT_TRUE(state.affected(path("foo.json")));
+}
+
+TEST(invalidate_global) {
+  auto &state{watch()};
+  state.depend_globally(path("jsonschema.json"));
+  {
+    const WatchScope scope{path("foo.json")};
+    WatchScope::depend(path("bar.json"));
+  }
+
+  EXPECT_TRUE(state.paths().contains(path("jsonschema.json")));
+  EXPECT_FALSE(state.invalidate({path("jsonschema.json"), path("baz.json")}));
+  EXPECT_FALSE(state.incremental());
+  EXPECT_TRUE(state.affected(path("qux.json")));
+  // Everything is processed and recorded again from scratch
+  EXPECT_TRUE(state.paths().empty());
+}
+
+// A directory of its own that no other test touches
+static auto fresh_directory(const char *name) -> std::filesystem::path {
+  const auto result{path(name)};
+  std::filesystem::remove_all(result);
+  std::filesystem::create_directories(result);
+  return result;
+}
+
+TEST(watcher_reports_changed_file) {
+  const auto directory{fresh_directory("watcher_changed")};
+  Watcher watcher;
+  watcher.add(directory);
+  std::ofstream{directory / "foo.json"} << "{}";
+
+  const auto changes{watcher.wait()};
+  EXPECT_TRUE(changes.has_value());
+  const std::set<std::filesystem::path> expected{directory / "foo.json"};
+  EXPECT_TRUE(changes.value() == expected);
+  std::filesystem::remove_all(directory);
+}
+
+#if defined(__linux__)
+TEST(watcher_overflow_reports_everything) {
+  // Every file we create queues at least two events, so creating as many
+  // files as the kernel queues events is guaranteed to overflow the queue
+  std::size_t limit{16384};
+  std::ifstream{"/proc/sys/fs/inotify/max_queued_events"} >> limit;
+  const auto directory{fresh_directory("watcher_overflow")};
+  Watcher watcher;
+  watcher.add(directory);
+  for (std::size_t index = 0; index < limit; index++) {
+    std::ofstream{directory / (std::to_string(index) + ".json")};
+  }
+
+  EXPECT_FALSE(watcher.wait().has_value());
+  std::filesystem::remove_all(directory);
+}
+#endif